@@ -0,0 +1,524 @@
+#include "database_benchmark.h"
+#include "core/io/json.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/project_settings.h"
+#include "../src/sqlite_bindings.h"
+
+void DatabaseBenchmark::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("set_row_count", "value"), &DatabaseBenchmark::set_row_count);
+    ClassDB::bind_method(D_METHOD("get_row_count"), &DatabaseBenchmark::get_row_count);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "row_count", PROPERTY_HINT_RANGE, "1,1000000,1,or_greater"), "set_row_count", "get_row_count");
+    ClassDB::bind_method(D_METHOD("run", "database_path"), &DatabaseBenchmark::run);
+    ClassDB::bind_method(D_METHOD("to_csv", "results"), &DatabaseBenchmark::to_csv);
+    ClassDB::bind_method(D_METHOD("to_json", "results"), &DatabaseBenchmark::to_json);
+}
+
+void DatabaseBenchmark::set_row_count(int value)
+{
+    ERR_FAIL_COND(value < 1);
+    row_count = value;
+    lookup_count = value;
+}
+
+void DatabaseBenchmark::add_result(const String &name, int rows, uint64_t usec, int64_t bytes_per_argument)
+{
+    Dictionary result;
+    result["name"] = name;
+    result["rows"] = rows;
+    result["usec"] = usec;
+    result["usec_per_row"] = rows > 0 ? (double)usec / rows : 0.0;
+    if(bytes_per_argument >= 0)
+        result["bytes_per_argument"] = bytes_per_argument;
+    results.append(result);
+
+    print_line(vformat("%s: %d rows in %d usec", name, rows, usec));
+}
+
+void DatabaseBenchmark::remove_database()
+{
+    static const char *suffixes[] = {"", "-journal", "-wal", "-shm"};
+    for(int i = 0; i < 4; i++)
+    {
+        String file = path + suffixes[i];
+        if(FileAccess::exists(file))
+        {
+            DirAccessRef dir = DirAccess::create_for_path(file);
+            dir->remove(file);
+        }
+    }
+}
+
+Ref<DatabaseSQLite> DatabaseBenchmark::open_database(int journal_mode)
+{
+    remove_database();
+
+    Ref<DatabaseSQLite> database;
+    database.instance();
+    database->set_journal_mode(journal_mode);
+    bool opened = database->open(path, DatabaseSQLite::OPEN_DEFAULT);
+    ERR_FAIL_COND_V_MSG(!opened, Ref<DatabaseSQLite>(), "Benchmark failed to open a database at " + path + ".");
+
+    Ref<Cursor> cursor = database->cursor();
+    if(!cursor->execute("CREATE TABLE item (id INTEGER PRIMARY KEY, name TEXT, value REAL, data BLOB)", Array()) || database->commit() != OK)
+    {
+        database->close();
+        ERR_FAIL_V_MSG(Ref<DatabaseSQLite>(), "Benchmark failed to create its table.");
+    }
+    return database;
+}
+
+static Array item_row(int i)
+{
+    Array row;
+    row.append(i);
+    row.append("item " + itos(i));
+    row.append(i * 0.5);
+    row.append(Variant());
+    return row;
+}
+
+bool DatabaseBenchmark::insert_items(const Ref<DatabaseSQLite> &database)
+{
+    Array rows;
+    for(int i = 0; i < row_count; i++)
+    {
+        rows.append(item_row(i));
+    }
+
+    Ref<Cursor> cursor = database->cursor();
+    bool inserted = cursor->execute_many("INSERT INTO item VALUES (?, ?, ?, ?)", rows) && database->commit() == OK;
+    cursor->close();
+    if(!inserted)
+    {
+        database->close();
+        ERR_FAIL_V_MSG(false, "Benchmark failed to insert its rows.");
+    }
+    return true;
+}
+
+void DatabaseBenchmark::bench_insert()
+{
+    Ref<DatabaseSQLite> database = open_database(DatabaseSQLite::JOURNAL_MODE_DEFAULT);
+    ERR_FAIL_COND(database.is_null());
+    Ref<Cursor> cursor = database->cursor();
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for(int i = 0; i < row_count; i++)
+    {
+        cursor->execute("INSERT INTO item VALUES (?, ?, ?, ?)", item_row(i));
+    }
+    database->commit();
+    add_result("single_insert", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    Array rows;
+    for(int i = 0; i < row_count; i++)
+    {
+        rows.append(item_row(row_count + i));
+    }
+
+    start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute_many("INSERT INTO item VALUES (?, ?, ?, ?)", rows);
+    database->commit();
+    add_result("execute_many_insert", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    PackedInt64Array ids;
+    PackedStringArray names;
+    PackedFloat64Array values;
+    for(int i = 0; i < row_count; i++)
+    {
+        ids.push_back(row_count * 2 + i);
+        names.push_back("item " + itos(i));
+        values.push_back(i * 0.5);
+    }
+    Array columns;
+    columns.append(ids);
+    columns.append(names);
+    columns.append(values);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute_many_columns("INSERT INTO item (id, name, value) VALUES (?, ?, ?)", columns);
+    database->commit();
+    add_result("execute_many_columns_insert", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    database->close();
+}
+
+void DatabaseBenchmark::bench_lookup()
+{
+    Ref<DatabaseSQLite> database = open_database(DatabaseSQLite::JOURNAL_MODE_DEFAULT);
+    ERR_FAIL_COND(database.is_null());
+    if(!insert_items(database))
+        return;
+    Ref<Cursor> cursor = database->cursor();
+
+    Array arguments;
+    arguments.resize(1);
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for(int i = 0; i < lookup_count; i++)
+    {
+        arguments[0] = (i * 7919) % row_count;
+        cursor->execute("SELECT * FROM item WHERE id = ?", arguments);
+        cursor->fetch_one();
+    }
+    add_result("point_lookup", lookup_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    Ref<PreparedStatement> statement = database->prepare("SELECT * FROM item WHERE id = ?");
+    start = OS::get_singleton()->get_ticks_usec();
+    for(int i = 0; i < lookup_count; i++)
+    {
+        statement->bind(0, (i * 7919) % row_count);
+        statement->step();
+        statement->get_row();
+        statement->reset();
+    }
+    add_result("prepared_point_lookup", lookup_count, OS::get_singleton()->get_ticks_usec() - start);
+    statement->close();
+
+    database->close();
+}
+
+void DatabaseBenchmark::bench_scan()
+{
+    Ref<DatabaseSQLite> database = open_database(DatabaseSQLite::JOURNAL_MODE_DEFAULT);
+    ERR_FAIL_COND(database.is_null());
+    if(!insert_items(database))
+        return;
+    Ref<Cursor> cursor = database->cursor();
+    // Streaming is specific to SQLite cursors, everything else goes through Cursor
+    Ref<CursorSQLite> sqlite_cursor;
+    sqlite_cursor = cursor;
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute("SELECT * FROM item", Array());
+    cursor->fetch_all();
+    add_result("full_scan_fetch_all", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    cursor->set_row_format(Cursor::ROW_FORMAT_ARRAY);
+    start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute("SELECT * FROM item", Array());
+    cursor->fetch_all();
+    add_result("full_scan_fetch_all_array", row_count, OS::get_singleton()->get_ticks_usec() - start);
+    cursor->set_row_format(Cursor::ROW_FORMAT_DICTIONARY);
+
+    sqlite_cursor->set_streaming(true);
+    start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute("SELECT * FROM item", Array());
+    while(cursor->fetch_many(100).size() > 0)
+    {
+    }
+    add_result("streaming_fetch_many_100", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute("SELECT * FROM item", Array());
+    cursor->fetch_columns();
+    add_result("streaming_fetch_columns", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    cursor->close();
+    database->close();
+}
+
+void DatabaseBenchmark::bench_integers()
+{
+    Ref<DatabaseSQLite> database = open_database(DatabaseSQLite::JOURNAL_MODE_DEFAULT);
+    ERR_FAIL_COND(database.is_null());
+    Ref<Cursor> cursor = database->cursor();
+    if(!cursor->execute("CREATE TABLE event (id INTEGER PRIMARY KEY, entity INTEGER, time INTEGER, flags INTEGER)", Array()) || database->commit() != OK)
+    {
+        database->close();
+        ERR_FAIL_MSG("Integer benchmark failed to create its table.");
+    }
+
+    // Values past 32 bits, like entity ids and microsecond timestamps
+    Array rows;
+    for(int i = 0; i < row_count; i++)
+    {
+        Array row;
+        row.append(((int64_t)1 << 40) + i);
+        row.append(((int64_t)1 << 35) * 3 + i);
+        row.append((int64_t)1600000000000000 + i * 16667);
+        row.append(i & 0xff);
+        rows.append(row);
+    }
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute_many("INSERT INTO event VALUES (?, ?, ?, ?)", rows);
+    database->commit();
+    add_result("integer_insert", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute("SELECT * FROM event", Array());
+    Array scanned = cursor->fetch_all();
+    add_result("integer_scan", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    // Truncated integers would make the benchmark meaningless
+    if(scanned.size() > 0 && (int64_t)((Dictionary)scanned[0])["id"] != ((int64_t)1 << 40))
+        print_error("Integer benchmark read back a truncated id.");
+
+    database->close();
+}
+
+void DatabaseBenchmark::bench_blobs()
+{
+    Ref<DatabaseSQLite> database = open_database(DatabaseSQLite::JOURNAL_MODE_DEFAULT);
+    ERR_FAIL_COND(database.is_null());
+    Ref<Cursor> cursor = database->cursor();
+
+    PackedByteArray blob;
+    blob.resize(blob_size);
+    for(int i = 0; i < blob_size; i++)
+    {
+        blob.set(i, i & 0xff);
+    }
+
+    Array arguments;
+    arguments.append(0);
+    arguments.append(blob);
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute("INSERT INTO item (id, data) VALUES (?, ?)", arguments);
+    database->commit();
+    add_result("blob_write_bind", 1, OS::get_singleton()->get_ticks_usec() - start);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute("SELECT data FROM item WHERE id = 0", Array());
+    cursor->fetch_one();
+    add_result("blob_read_fetch", 1, OS::get_singleton()->get_ticks_usec() - start);
+
+    static const int chunk_size = 64 * 1024;
+    PackedByteArray chunk = blob.subarray(0, chunk_size - 1);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    cursor->execute("INSERT INTO item (id, data) VALUES (1, zeroblob(" + itos(blob_size) + "))", Array());
+    Ref<BlobStream> stream = database->open_blob("item", "data", 1, true);
+    if(stream.is_null())
+    {
+        database->close();
+        ERR_FAIL_MSG("Blob benchmark failed to open a blob stream.");
+    }
+    for(int offset = 0; offset + chunk_size <= blob_size; offset += chunk_size)
+    {
+        stream->write(offset, chunk);
+    }
+    stream->close();
+    database->commit();
+    add_result("blob_write_stream", 1, OS::get_singleton()->get_ticks_usec() - start);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    stream = database->open_blob("item", "data", 1);
+    for(int offset = 0; offset + chunk_size <= blob_size; offset += chunk_size)
+    {
+        stream->read(offset, chunk_size);
+    }
+    stream->close();
+    add_result("blob_read_stream", 1, OS::get_singleton()->get_ticks_usec() - start);
+
+    database->close();
+}
+
+void DatabaseBenchmark::bench_commits()
+{
+    static const int modes[] = {DatabaseSQLite::JOURNAL_MODE_DELETE, DatabaseSQLite::JOURNAL_MODE_TRUNCATE, DatabaseSQLite::JOURNAL_MODE_WAL, DatabaseSQLite::JOURNAL_MODE_MEMORY};
+    static const char *names[] = {"delete", "truncate", "wal", "memory"};
+
+    for(int m = 0; m < 4; m++)
+    {
+        Ref<DatabaseSQLite> database = open_database(modes[m]);
+        ERR_FAIL_COND(database.is_null());
+        Ref<Cursor> cursor = database->cursor();
+
+        uint64_t start = OS::get_singleton()->get_ticks_usec();
+        for(int i = 0; i < commit_count; i++)
+        {
+            cursor->execute("INSERT INTO item VALUES (?, ?, ?, ?)", item_row(i));
+            database->commit();
+        }
+        add_result(String("commit_") + names[m], commit_count, OS::get_singleton()->get_ticks_usec() - start);
+
+        database->close();
+    }
+}
+
+// The same work as the wrapper cases, through the sqlite3 C API only
+void DatabaseBenchmark::bench_raw()
+{
+    remove_database();
+
+    sqlite3 *db;
+    int err = sqlite3_open_v2(ProjectSettings::get_singleton()->globalize_path(path).utf8().get_data(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+    if(err == SQLITE_OK)
+        err = sqlite3_exec(db, "CREATE TABLE item (id INTEGER PRIMARY KEY, name TEXT, value REAL, data BLOB)", nullptr, nullptr, nullptr);
+    if(err != SQLITE_OK)
+    {
+        print_error(String("Raw benchmark failed to create its database: ") + sqlite3_errmsg(db));
+        sqlite3_close_v2(db);
+        return;
+    }
+
+    sqlite3_stmt *stmt;
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+    sqlite3_prepare_v2(db, "INSERT INTO item VALUES (?, ?, ?, NULL)", -1, &stmt, nullptr);
+    for(int i = 0; i < row_count; i++)
+    {
+        CharString name = ("item " + itos(i)).utf8();
+        sqlite3_bind_int64(stmt, 1, i);
+        sqlite3_bind_text(stmt, 2, name.get_data(), name.length(), SQLITE_STATIC);
+        sqlite3_bind_double(stmt, 3, i * 0.5);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+    add_result("raw_bulk_insert", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    sqlite3_prepare_v2(db, "SELECT * FROM item WHERE id = ?", -1, &stmt, nullptr);
+    for(int i = 0; i < lookup_count; i++)
+    {
+        sqlite3_bind_int64(stmt, 1, (i * 7919) % row_count);
+        if(sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            sqlite3_column_int64(stmt, 0);
+            sqlite3_column_text(stmt, 1);
+            sqlite3_column_double(stmt, 2);
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    add_result("raw_point_lookup", lookup_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    sqlite3_prepare_v2(db, "SELECT * FROM item", -1, &stmt, nullptr);
+    while(sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        sqlite3_column_int64(stmt, 0);
+        sqlite3_column_text(stmt, 1);
+        sqlite3_column_double(stmt, 2);
+    }
+    sqlite3_finalize(stmt);
+    add_result("raw_full_scan", row_count, OS::get_singleton()->get_ticks_usec() - start);
+
+    sqlite3_close_v2(db);
+}
+
+// How arguments were bound before SQLiteBindings: a temporary UTF-8
+// conversion that SQLite copies again, and blobs copied by SQLite
+static int bind_transient(sqlite3_stmt *stmt, int index, const Variant &value)
+{
+    if(value.get_type() == Variant::STRING)
+        return sqlite3_bind_text(stmt, index, String(value).utf8().get_data(), -1, SQLITE_TRANSIENT);
+
+    PackedByteArray blob = value;
+    return sqlite3_bind_blob(stmt, index, blob.ptr(), blob.size(), SQLITE_TRANSIENT);
+}
+
+// Compares the bytes copied per bound argument before and after SQLiteBindings.
+// Copies made by SQLite are measured as the memory it holds after the bind,
+// the UTF-8 conversion of text is made by both and counted for both.
+void DatabaseBenchmark::bench_binding()
+{
+    sqlite3 *db;
+    int err = sqlite3_open_v2(":memory:", &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_MEMORY, nullptr);
+    ERR_FAIL_COND_MSG(err != SQLITE_OK, "Binding benchmark failed to open a database.");
+
+    sqlite3_stmt *stmt;
+    err = sqlite3_prepare_v2(db, "SELECT ?", -1, &stmt, nullptr);
+    if(err != SQLITE_OK)
+    {
+        sqlite3_close_v2(db);
+        ERR_FAIL_MSG("Binding benchmark failed to prepare its statement.");
+    }
+
+    String short_text;
+    String long_text;
+    for(int i = 0; i < 64 * 1024; i++)
+    {
+        if(i < 64)
+            short_text += String::chr('a' + i % 26);
+        long_text += String::chr('a' + i % 26);
+    }
+    PackedByteArray blob;
+    blob.resize(64 * 1024);
+    memset(blob.ptrw(), 1, blob.size());
+
+    Variant values[] = {short_text, long_text, blob};
+    const char *names[] = {"bind_text_64", "bind_text_64k", "bind_blob_64k"};
+
+    SQLiteBindings bindings;
+    for(int v = 0; v < 3; v++)
+    {
+        int64_t converted = values[v].get_type() == Variant::STRING ? String(values[v]).utf8().length() : 0;
+
+        for(int after = 0; after < 2; after++)
+        {
+            int64_t copied = 0;
+            uint64_t usec = 0;
+            for(int i = 0; i < row_count; i++)
+            {
+                // Frees the copies SQLite made for the previous bind
+                sqlite3_clear_bindings(stmt);
+                bindings.clear();
+
+                sqlite3_int64 before = sqlite3_memory_used();
+                uint64_t start = OS::get_singleton()->get_ticks_usec();
+                err = after ? bindings.bind(stmt, 1, values[v]) : bind_transient(stmt, 1, values[v]);
+                usec += OS::get_singleton()->get_ticks_usec() - start;
+                copied += sqlite3_memory_used() - before + converted;
+
+                if(err != SQLITE_OK)
+                {
+                    print_error(String("Binding benchmark failed to bind: ") + sqlite3_errstr(err));
+                    break;
+                }
+            }
+            add_result(String(names[v]) + (after ? "_after" : "_before"), row_count, usec, copied / row_count);
+        }
+    }
+
+    sqlite3_clear_bindings(stmt);
+    sqlite3_finalize(stmt);
+    sqlite3_close_v2(db);
+}
+
+Array DatabaseBenchmark::run(String database_path)
+{
+    ERR_FAIL_COND_V(database_path.empty(), Array());
+
+    path = database_path;
+    results = Array();
+
+    bench_insert();
+    bench_lookup();
+    bench_scan();
+    bench_integers();
+    bench_blobs();
+    bench_commits();
+    bench_raw();
+    bench_binding();
+
+    remove_database();
+    return results;
+}
+
+String DatabaseBenchmark::to_csv(Array results) const
+{
+    String csv = "name,rows,usec,usec_per_row,bytes_per_argument\n";
+    for(int i = 0; i < results.size(); i++)
+    {
+        Dictionary result = results[i];
+        csv += String(result["name"]) + "," + itos(result["rows"]) + "," + itos(result["usec"]) + "," + rtos(result["usec_per_row"]) + ",";
+        if(result.has("bytes_per_argument"))
+            csv += itos(result["bytes_per_argument"]);
+        csv += "\n";
+    }
+    return csv;
+}
+
+String DatabaseBenchmark::to_json(Array results) const
+{
+    return JSON::print(results, "\t");
+}
@@ -0,0 +1,60 @@
+#ifndef GODOT_DATABASE_BENCHMARK_H
+#define GODOT_DATABASE_BENCHMARK_H
+
+#include "core/reference.h"
+#include "core/ustring.h"
+#include "../src/db_sqlite.h"
+
+/// Measures the database module against raw sqlite3 C API calls.
+///
+/// Only built when the module is compiled with database_benchmarks=yes.
+/// Run it headless with demo/benchmark.gd.
+class DatabaseBenchmark : public Reference {
+    GDCLASS(DatabaseBenchmark, Reference);
+
+    protected:
+    static void _bind_methods();
+
+    int row_count = 10000;
+    int lookup_count = 10000;
+    int commit_count = 100;
+    int blob_size = 4 * 1024 * 1024;
+
+    String path;
+    Array results;
+
+    /// bytes_per_argument is only reported when it isn't negative
+    void add_result(const String &name, int rows, uint64_t usec, int64_t bytes_per_argument = -1);
+
+    /// Opens a new database at path, deleting any previous one
+    Ref<DatabaseSQLite> open_database(int journal_mode);
+    /// Fills the item table with row_count rows, closing the database if it fails
+    bool insert_items(const Ref<DatabaseSQLite> &database);
+    void remove_database();
+
+    void bench_insert();
+    void bench_lookup();
+    void bench_scan();
+    void bench_integers();
+    void bench_blobs();
+    void bench_commits();
+    void bench_raw();
+    void bench_binding();
+
+    public:
+    /// Number of rows inserted and scanned by each case
+    void set_row_count(int value);
+    int get_row_count() const {return row_count;}
+
+    /// Runs every case on a database file at database_path, which is deleted afterwards.
+    /// Returns an Array with a Dictionary per case holding
+    /// "name", "rows", "usec" and "usec_per_row", and "bytes_per_argument"
+    /// for the binding cases.
+    Array run(String database_path);
+
+    /// Formats the results of run()
+    String to_csv(Array results) const;
+    String to_json(Array results) const;
+};
+
+#endif
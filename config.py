@@ -1,5 +1,13 @@
 def can_build(env, platform):
     return True
 
+def get_opts(platform):
+    from SCons.Variables import BoolVariable
+
+    return [
+        BoolVariable("database_benchmarks", "Build the DatabaseBenchmark class for measuring the database module", False),
+        BoolVariable("sqlite_progress_callback", "Compile SQLite with the progress callback, needed for query timeouts. Every statement then checks its deadline each 1000 instructions", False),
+    ]
+
 def configure(env):
     pass
\ No newline at end of file
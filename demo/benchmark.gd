@@ -0,0 +1,29 @@
+extends SceneTree
+
+# Runs the database benchmarks headless and writes the results as CSV and JSON.
+# The module has to be built with database_benchmarks=yes.
+#
+# godot --no-window --path demo --script res://benchmark.gd [rows] [output path without extension]
+
+func _init():
+	var args = OS.get_cmdline_args()
+	var benchmark = DatabaseBenchmark.new()
+	var output = "user://database_benchmark"
+
+	var index = args.find("res://benchmark.gd")
+	if index != -1 and args.size() > index + 1:
+		benchmark.row_count = int(args[index + 1])
+	if index != -1 and args.size() > index + 2:
+		output = args[index + 2]
+
+	var results = benchmark.run("user://database_benchmark.db")
+
+	var file = File.new()
+	file.open(output + ".csv", File.WRITE)
+	file.store_string(benchmark.to_csv(results))
+	file.close()
+	file.open(output + ".json", File.WRITE)
+	file.store_string(benchmark.to_json(results))
+	file.close()
+
+	quit()
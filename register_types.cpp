@@ -3,19 +3,49 @@
 #include "core/class_db.h"
 
 #include "src/database.h"
+#include "src/blob_stream.h"
 #include "src/cursor.h"
+#include "src/database_executor.h"
+#include "src/database_query.h"
+#include "src/prepared_statement.h"
 #include "src/db_sqlite.h"
+#include "src/database_monitor_sqlite.h"
+#include "src/spatial_index_sqlite.h"
+#include "src/sqlite_pack_vfs.h"
+
+#ifdef DATABASE_BENCHMARKS_ENABLED
+#include "benchmark/database_benchmark.h"
+#endif
+
+static DatabaseMonitorSQLite *database_monitor = nullptr;
 
 void register_database_types()
 {
     ClassDB::register_virtual_class<Database>();
     ClassDB::register_virtual_class<Cursor>();
+    ClassDB::register_virtual_class<PreparedStatement>();
+    ClassDB::register_virtual_class<BlobStream>();
+    ClassDB::register_class<DatabaseQuery>();
+    ClassDB::register_class<DatabaseExecutor>();
     sqlite3_initialize();
+    sqlite_pack_vfs_register();
     ClassDB::register_class<DatabaseSQLite>();
     ClassDB::register_class<CursorSQLite>();
+    ClassDB::register_class<PreparedStatementSQLite>();
+    ClassDB::register_class<BlobStreamSQLite>();
+    ClassDB::register_class<SpatialIndexSQLite>();
+    ClassDB::register_virtual_class<DatabaseMonitorSQLite>();
+    database_monitor = memnew(DatabaseMonitorSQLite);
+
+#ifdef DATABASE_BENCHMARKS_ENABLED
+    ClassDB::register_class<DatabaseBenchmark>();
+#endif
 }
 
 void unregister_database_types()
 {
+    memdelete(database_monitor);
+    database_monitor = nullptr;
+    sqlite_pack_vfs_unregister();
     sqlite3_shutdown();
 }
\ No newline at end of file
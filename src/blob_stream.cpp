@@ -0,0 +1,12 @@
+#include "blob_stream.h"
+
+void BlobStream::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("is_open"), &BlobStream::is_open);
+    ClassDB::bind_method(D_METHOD("close"), &BlobStream::close);
+    ClassDB::bind_method(D_METHOD("is_writable"), &BlobStream::is_writable);
+    ClassDB::bind_method(D_METHOD("get_length"), &BlobStream::get_length);
+    ClassDB::bind_method(D_METHOD("read", "offset", "length"), &BlobStream::read);
+    ClassDB::bind_method(D_METHOD("write", "offset", "data"), &BlobStream::write);
+    ClassDB::bind_method(D_METHOD("reopen", "row"), &BlobStream::reopen);
+}
@@ -0,0 +1,44 @@
+#ifndef GODOT_BLOB_STREAM_H
+#define GODOT_BLOB_STREAM_H
+
+#include "core/reference.h"
+#include "core/ustring.h"
+
+/// Incremental access to a single binary cell of a database,
+/// so large blobs can be read and written in chunks.
+///
+/// The size of the blob is fixed while it is open, writes can't
+/// grow it. Offsets are in bytes, starting from 0.
+class BlobStream : public Reference {
+    GDCLASS(BlobStream, Reference);
+
+    protected:
+    static void _bind_methods();
+
+    public:
+    /// Returns true if the blob is still valid and its database is open
+    virtual bool is_open() = 0;
+
+    /// Release the blob, rendering it invalid for further use.
+    virtual void close() = 0;
+
+    /// Returns true if the blob was opened for writing.
+    virtual bool is_writable() = 0;
+
+    /// Returns the size of the blob in bytes.
+    virtual int get_length() = 0;
+
+    /// Reads length bytes starting at offset.
+    /// Returns an empty PackedByteArray if the range is out of bounds or an error occurs.
+    virtual PackedByteArray read(int offset, int length) = 0;
+
+    /// Writes data starting at offset.
+    /// Returns false if the range is out of bounds or an error occurs.
+    virtual bool write(int offset, PackedByteArray data) = 0;
+
+    /// Moves the stream to the cell of another row of the same table and column.
+    /// OPTIONAL. Should print an error if not supported.
+    virtual bool reopen(int64_t row) = 0;
+};
+
+#endif
@@ -2,14 +2,31 @@
 
 void Cursor::_bind_methods()
 {
+    BIND_ENUM_CONSTANT(ROW_FORMAT_DICTIONARY);
+    BIND_ENUM_CONSTANT(ROW_FORMAT_ARRAY);
+
+    ClassDB::bind_method(D_METHOD("set_row_format", "value"), &Cursor::set_row_format);
+    ClassDB::bind_method(D_METHOD("get_row_format"), &Cursor::get_row_format);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "row_format", PROPERTY_HINT_ENUM, "Dictionary,Array"), "set_row_format", "get_row_format");
+
     ClassDB::bind_method(D_METHOD("is_open"), &Cursor::is_open);
     ClassDB::bind_method(D_METHOD("close"), &Cursor::close);
     ClassDB::bind_method(D_METHOD("callproc", "procname", "arguments"), &Cursor::callproc, DEFVAL(Array()));
     ClassDB::bind_method(D_METHOD("execute", "statement", "arguments"), &Cursor::execute, DEFVAL(Array()));
     ClassDB::bind_method(D_METHOD("execute_many", "statement", "arguments"), &Cursor::execute_many);
+    ClassDB::bind_method(D_METHOD("execute_many_columns", "statement", "columns"), &Cursor::execute_many_columns);
     ClassDB::bind_method(D_METHOD("get_row_count"), &Cursor::get_row_count);
     ClassDB::bind_method(D_METHOD("scroll", "amount", "absolute"), &Cursor::scroll, DEFVAL(false));
+    ClassDB::bind_method(D_METHOD("get_description"), &Cursor::get_description);
     ClassDB::bind_method(D_METHOD("fetch_one"), &Cursor::fetch_one);
     ClassDB::bind_method(D_METHOD("fetch_many", "size"), &Cursor::fetch_many);
     ClassDB::bind_method(D_METHOD("fetch_all"), &Cursor::fetch_all);
+    ClassDB::bind_method(D_METHOD("fetch_columns_many", "size"), &Cursor::fetch_columns_many);
+    ClassDB::bind_method(D_METHOD("fetch_columns"), &Cursor::fetch_columns);
+}
+
+void Cursor::set_row_format(int value)
+{
+    ERR_FAIL_COND_MSG(value != ROW_FORMAT_DICTIONARY && value != ROW_FORMAT_ARRAY, "Unknown cursor row format " + itos(value));
+    row_format = value;
 }
\ No newline at end of file
@@ -10,7 +10,19 @@ class Cursor : public Reference {
     protected:
     static void _bind_methods();
 
+    int row_format = ROW_FORMAT_DICTIONARY;
+
     public:
+    /// Rows are Dictionaries keyed by column name
+    static const int ROW_FORMAT_DICTIONARY = 0;
+    /// Rows are Arrays indexed by column, see get_description()
+    static const int ROW_FORMAT_ARRAY = 1;
+
+    /// Set the format of the rows returned by the fetch methods.
+    /// ROW_FORMAT_DICTIONARY by default
+    void set_row_format(int value);
+    int get_row_format() const {return row_format;}
+
     // Returns true if the cursor is still valid and connected to a database
     virtual bool is_open() = 0;
     
@@ -27,6 +39,12 @@ class Cursor : public Reference {
     /// Prepares a database statement and executes it with the given Array of Arrays of arguments.
     virtual bool execute_many(String statement, Array arguments) = 0;
 
+    /// Prepares a database statement and executes it once per row of the given columns.
+    /// Each argument is a packed array or an Array holding that parameter's value
+    /// for every row, and all of them must have the same size.
+    /// OPTIONAL. Should print an error if not supported.
+    virtual bool execute_many_columns(String statement, Array columns) = 0;
+
     /// Returns the number of rows affected by the last query.
     /// OPTIONAL. Returns -1 if the interface cannot determine the number of rows affected.
     virtual int get_row_count() {return -1;}
@@ -35,19 +53,37 @@ class Cursor : public Reference {
     /// OPTIONAL. Should print an error if not supported.
     virtual void scroll(int amount, bool absolute) = 0;
     
-    /// Returns a single row from the last result as a Dictionary.
-    /// Returns an empty Dictionary if there were no results, or the cursor reached the end
+    /// Returns the column names of the last result, in the order
+    /// of the values of ROW_FORMAT_ARRAY rows.
+    virtual PackedStringArray get_description() = 0;
+
+    /// Returns a single row from the last result as a Dictionary, or as an Array
+    /// when the row format is ROW_FORMAT_ARRAY.
+    /// Returns an empty row if there were no results, or the cursor reached the end
     /// of the results set.
-    virtual Dictionary fetch_one() = 0;
+    virtual Variant fetch_one() = 0;
 
-    /// Returns an Array of Dictionary rows.
+    /// Returns an Array of rows.
     /// Returns an empty Array if there were no results, or the cursor reached the end
     /// of the result set.
     virtual Array fetch_many(int size) = 0;
 
-    /// Returns the remaining result rows from the last query as an Array of Dictionaries.
+    /// Returns the remaining result rows from the last query as an Array of rows.
     /// Returns an empty Array if there were no results.
     virtual Array fetch_all() = 0;
+
+    /// Returns up to size rows from the last result, split into columns.
+    /// The returned Dictionary holds "names", a PackedStringArray of column names,
+    /// "columns", an Array with one packed array per column (PackedInt64Array,
+    /// PackedFloat64Array, PackedStringArray, or an Array for mixed and binary data),
+    /// and "valid", an Array with one PackedByteArray per column where NULL cells are 0.
+    /// OPTIONAL. Should print an error if not supported.
+    virtual Dictionary fetch_columns_many(int size) = 0;
+
+    /// Returns the remaining result rows from the last query split into columns,
+    /// in the same format as fetch_columns_many().
+    /// OPTIONAL. Should print an error if not supported.
+    virtual Dictionary fetch_columns() = 0;
 };
 
 #endif
\ No newline at end of file
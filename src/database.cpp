@@ -6,5 +6,63 @@ void Database::_bind_methods()
     ClassDB::bind_method(D_METHOD("close"), &Database::close);
     ClassDB::bind_method(D_METHOD("commit"), &Database::commit);
     ClassDB::bind_method(D_METHOD("rollback"), &Database::rollback);
+    ClassDB::bind_method(D_METHOD("interrupt"), &Database::interrupt);
     ClassDB::bind_method(D_METHOD("cursor"), &Database::cursor);
+    ClassDB::bind_method(D_METHOD("prepare", "statement"), &Database::prepare);
+    ClassDB::bind_method(D_METHOD("set_executor", "value"), &Database::set_executor);
+    ClassDB::bind_method(D_METHOD("get_executor"), &Database::get_executor);
+    ClassDB::bind_method(D_METHOD("execute_async", "statement", "arguments"), &Database::execute_async, DEFVAL(Array()));
+    ClassDB::bind_method(D_METHOD("execute_many_async", "statement", "arguments"), &Database::execute_many_async);
+    ClassDB::bind_method(D_METHOD("commit_async"), &Database::commit_async);
+    ClassDB::bind_method(D_METHOD("rollback_async"), &Database::rollback_async);
+}
+
+void Database::set_executor(const Ref<DatabaseExecutor> &value)
+{
+    MutexLock lock(executor_mutex);
+    executor = value;
+}
+
+Ref<DatabaseExecutor> Database::get_executor()
+{
+    MutexLock lock(executor_mutex);
+    if(executor.is_null())
+        executor.instance();
+
+    return executor;
+}
+
+Ref<DatabaseQuery> Database::submit_query(int type, String statement, Array arguments)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Ref<DatabaseQuery>(), "Database is not open!");
+
+    Ref<DatabaseQuery> query;
+    query.instance();
+    query->type = type;
+    query->database = Ref(this);
+    query->statement = statement;
+    query->arguments = arguments;
+
+    get_executor()->submit(query);
+    return query;
+}
+
+Ref<DatabaseQuery> Database::execute_async(String statement, Array arguments)
+{
+    return submit_query(DatabaseQuery::TYPE_EXECUTE, statement, arguments);
+}
+
+Ref<DatabaseQuery> Database::execute_many_async(String statement, Array arguments)
+{
+    return submit_query(DatabaseQuery::TYPE_EXECUTE_MANY, statement, arguments);
+}
+
+Ref<DatabaseQuery> Database::commit_async()
+{
+    return submit_query(DatabaseQuery::TYPE_COMMIT, String(), Array());
+}
+
+Ref<DatabaseQuery> Database::rollback_async()
+{
+    return submit_query(DatabaseQuery::TYPE_ROLLBACK, String(), Array());
 }
\ No newline at end of file
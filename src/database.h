@@ -1,8 +1,12 @@
 #ifndef GODOT_DATABASE_H
 #define GODOT_DATABASE_H
 
+#include "core/os/mutex.h"
 #include "core/reference.h"
 #include "cursor.h"
+#include "database_executor.h"
+#include "database_query.h"
+#include "prepared_statement.h"
 
 /// Interface for connecting to external databases
 ///
@@ -17,6 +21,12 @@ class Database : public Reference {
     protected:
     static void _bind_methods();
 
+    Ref<DatabaseExecutor> executor;
+    Mutex executor_mutex; // get_executor() is called from any thread
+
+    /// Queues an operation on the executor
+    Ref<DatabaseQuery> submit_query(int type, String statement, Array arguments);
+
     public:
     virtual bool is_open() = 0;
 
@@ -34,18 +44,49 @@ class Database : public Reference {
     ///
     /// For databases that don't implement transactions, this
     /// method can print a warning and do nothing.
-    virtual void commit() = 0;
+    /// Returns OK, or the error that prevented the commit
+    virtual Error commit() = 0;
 
     /// Rollback the effects of the current transaction.
     ///
     /// For databases that don't implement transactions, this
     /// method should print an error and do nothing.
-    virtual void rollback() = 0;
+    /// Returns OK, or the error that prevented the rollback
+    virtual Error rollback() = 0;
+
+    /// Stop the statements running on the database, from any thread.
+    /// Interrupted statements fail as soon as possible.
+    ///
+    /// For databases that can't interrupt statements, this
+    /// method does nothing.
+    virtual void interrupt() {}
 
     /// Return a cursor to the database.
     /// If the database doesn't implement cursors,
     /// cursor support should be emulated.
     virtual Ref<Cursor> cursor() = 0;
+
+    /// Compile a statement that can be executed many times
+    /// with different parameters.
+    /// Returns an invalid reference if the statement fails to compile.
+    virtual Ref<PreparedStatement> prepare(String statement) = 0;
+
+    /// Set the executor that runs the asynchronous operations of this database.
+    /// Several databases can share an executor.
+    void set_executor(const Ref<DatabaseExecutor> &value);
+
+    /// Returns the executor of this database, creating one with
+    /// a single worker thread if none was set
+    Ref<DatabaseExecutor> get_executor();
+
+    /// Asynchronous versions of execute(), execute_many(), commit() and rollback().
+    /// The operations run in order on a worker thread of the executor,
+    /// and the returned query emits "completed" on the main thread once it is done.
+    /// Synchronous calls on the database aren't ordered with them.
+    Ref<DatabaseQuery> execute_async(String statement, Array arguments);
+    Ref<DatabaseQuery> execute_many_async(String statement, Array arguments);
+    Ref<DatabaseQuery> commit_async();
+    Ref<DatabaseQuery> rollback_async();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "database_executor.h"
+#include "database.h"
+
+void DatabaseExecutor::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("set_thread_count", "value"), &DatabaseExecutor::set_thread_count);
+    ClassDB::bind_method(D_METHOD("get_thread_count"), &DatabaseExecutor::get_thread_count);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "thread_count", PROPERTY_HINT_RANGE, "1,64,1,or_greater"), "set_thread_count", "get_thread_count");
+    ClassDB::bind_method(D_METHOD("get_queue_size"), &DatabaseExecutor::get_queue_size);
+    ClassDB::bind_method(D_METHOD("_flush_finished"), &DatabaseExecutor::_flush_finished);
+
+    ADD_SIGNAL(MethodInfo("query_completed", PropertyInfo(Variant::OBJECT, "query", PROPERTY_HINT_RESOURCE_TYPE, "DatabaseQuery")));
+}
+
+DatabaseExecutor::~DatabaseExecutor()
+{
+    {
+        // Don't wait for long running queries to finish on their own
+        MutexLock lock(mutex);
+        for(Set<Database *>::Element *E = busy_databases.front(); E; E = E->next())
+        {
+            E->get()->interrupt();
+        }
+    }
+
+    stop_threads();
+}
+
+void DatabaseExecutor::thread_func(void *userdata)
+{
+    ((DatabaseExecutor *)userdata)->thread_loop();
+}
+
+void DatabaseExecutor::thread_loop()
+{
+    while(true)
+    {
+        semaphore.wait();
+
+        DatabaseQuery *query;
+        {
+            MutexLock lock(mutex);
+            if(exiting)
+                return;
+
+            // Nothing may be runnable if every queued query belongs to a busy
+            // database, the worker running it will pick them up instead
+            query = take_query(nullptr);
+        }
+
+        while(query)
+        {
+            query->run();
+
+            MutexLock lock(mutex);
+            query->state = DatabaseQuery::STATE_FINISHED;
+            if(!flush_queued)
+            {
+                flush_queued = true;
+                call_deferred("_flush_finished");
+            }
+
+            // Keep running the queries of the same database in order
+            Database *database = query->database.ptr();
+            query = exiting ? nullptr : take_query(database);
+            if(!query)
+                busy_databases.erase(database);
+        }
+    }
+}
+
+DatabaseQuery *DatabaseExecutor::take_query(Database *database)
+{
+    for(List<Ref<DatabaseQuery>>::Element *E = queries.front(); E; E = E->next())
+    {
+        DatabaseQuery *query = E->get().ptr();
+        if(query->state != DatabaseQuery::STATE_PENDING)
+            continue;
+
+        Database *query_database = query->database.ptr();
+        if(database != nullptr ? query_database != database : busy_databases.has(query_database))
+            continue;
+
+        query->state = DatabaseQuery::STATE_RUNNING;
+        busy_databases.insert(query_database);
+        return query;
+    }
+
+    return nullptr;
+}
+
+void DatabaseExecutor::start_threads()
+{
+    exiting = false;
+    for(int i = 0; i < thread_count; i++)
+    {
+        threads.push_back(Thread::create(thread_func, this));
+    }
+
+    // Stopped workers may have consumed the posts of pending queries
+    for(List<Ref<DatabaseQuery>>::Element *E = queries.front(); E; E = E->next())
+    {
+        if(E->get()->state == DatabaseQuery::STATE_PENDING)
+            semaphore.post();
+    }
+}
+
+void DatabaseExecutor::stop_threads()
+{
+    {
+        MutexLock lock(mutex);
+        exiting = true;
+    }
+
+    // Running queries are finished before their worker exits
+    for(int i = 0; i < threads.size(); i++)
+    {
+        semaphore.post();
+    }
+    for(int i = 0; i < threads.size(); i++)
+    {
+        Thread::wait_to_finish(threads[i]);
+        memdelete(threads[i]);
+    }
+    threads.clear();
+}
+
+void DatabaseExecutor::_flush_finished()
+{
+    // The finished queries may hold the last reference to a database using this executor
+    Ref<DatabaseExecutor> self = Ref(this);
+    List<Ref<DatabaseQuery>> finished;
+    {
+        MutexLock lock(mutex);
+        flush_queued = false;
+
+        List<Ref<DatabaseQuery>>::Element *E = queries.front();
+        while(E)
+        {
+            List<Ref<DatabaseQuery>>::Element *next = E->next();
+            if(E->get()->state == DatabaseQuery::STATE_FINISHED)
+            {
+                finished.push_back(E->get());
+                queries.erase(E);
+            }
+            E = next;
+        }
+    }
+
+    // Signal handlers are free to submit more queries
+    for(List<Ref<DatabaseQuery>>::Element *E = finished.front(); E; E = E->next())
+    {
+        E->get()->complete();
+        emit_signal("query_completed", E->get());
+    }
+}
+
+void DatabaseExecutor::set_thread_count(int value)
+{
+    ERR_FAIL_COND(value < 1);
+
+    if(threads.empty())
+    {
+        thread_count = value;
+        return;
+    }
+
+    stop_threads();
+    thread_count = value;
+
+    MutexLock lock(mutex);
+    start_threads();
+}
+
+int DatabaseExecutor::get_queue_size()
+{
+    MutexLock lock(mutex);
+    return queries.size();
+}
+
+void DatabaseExecutor::submit(const Ref<DatabaseQuery> &query)
+{
+    ERR_FAIL_COND(query.is_null());
+    ERR_FAIL_COND_MSG(query->state != DatabaseQuery::STATE_PENDING, "Database query was already submitted.");
+
+    MutexLock lock(mutex);
+    if(threads.empty())
+        start_threads();
+
+    queries.push_back(query);
+    semaphore.post();
+}
@@ -0,0 +1,69 @@
+#ifndef GODOT_DATABASE_EXECUTOR_H
+#define GODOT_DATABASE_EXECUTOR_H
+
+#include "core/list.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/reference.h"
+#include "core/set.h"
+#include "database_query.h"
+
+/// Pool of worker threads that run DatabaseQuery operations.
+///
+/// Queries of the same database run one at a time, in the order they
+/// were submitted. Queries of different databases run in parallel.
+/// Completion is reported on the main thread, through the query's
+/// "completed" signal and the executor's "query_completed" signal.
+///
+/// An executor can be shared by several databases with Database.set_executor().
+class DatabaseExecutor : public Reference {
+    GDCLASS(DatabaseExecutor, Reference);
+
+    protected:
+    static void _bind_methods();
+
+    int thread_count = 1;
+    Vector<Thread *> threads;
+    bool exiting = false;
+
+    Mutex mutex;
+    Semaphore semaphore; // Posted once per submitted query
+
+    // Every query that hasn't been reported yet, in submission order.
+    // Workers only use raw pointers, so the last reference to a query
+    // and its database is always released on the main thread.
+    List<Ref<DatabaseQuery>> queries;
+    Set<Database *> busy_databases; // Databases with a running query
+    bool flush_queued = false;
+
+    static void thread_func(void *userdata);
+    void thread_loop();
+
+    /// Marks the next pending query of database as running and returns it.
+    /// If database is null, takes the next query of any idle database.
+    /// Must be called with the mutex locked.
+    DatabaseQuery *take_query(Database *database);
+
+    void start_threads();
+    void stop_threads();
+
+    /// Reports every finished query on the main thread
+    void _flush_finished();
+
+    public:
+    /// Set the number of worker threads.
+    /// 1 by default
+    void set_thread_count(int value);
+    int get_thread_count() const {return thread_count;}
+
+    /// Returns the number of queries that haven't been reported yet
+    int get_queue_size();
+
+    /// Queues query to run on a worker thread
+    void submit(const Ref<DatabaseQuery> &query);
+
+    ~DatabaseExecutor();
+};
+
+#endif
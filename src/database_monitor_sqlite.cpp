@@ -0,0 +1,240 @@
+#include "database_monitor_sqlite.h"
+#include "db_sqlite.h"
+#include "core/debugger/engine_debugger.h"
+#include "core/os/os.h"
+#include "main/performance.h"
+
+volatile uint64_t SQLiteActivity::queries = 0;
+volatile uint64_t SQLiteActivity::rows_fetched = 0;
+volatile uint64_t SQLiteActivity::query_usec = 0;
+volatile uint64_t SQLiteActivity::open_cursors = 0;
+
+SQLiteQueryTimer::SQLiteQueryTimer(uint64_t query_count)
+{
+    start = OS::get_singleton()->get_ticks_usec();
+    count = query_count;
+}
+
+SQLiteQueryTimer::~SQLiteQueryTimer()
+{
+    SQLiteActivity::add_query(count, OS::get_singleton()->get_ticks_usec() - start);
+}
+
+DatabaseMonitorSQLite *DatabaseMonitorSQLite::singleton = nullptr;
+
+static const char *monitor_names[] = {
+    "database/queries_per_second",
+    "database/rows_fetched_per_second",
+    "database/statement_cache_hit_rate",
+    "database/open_cursors",
+    "database/sqlite_memory_used",
+    "database/page_cache_hits_per_second",
+    "database/page_cache_misses_per_second",
+};
+
+static const char *monitor_methods[] = {
+    "get_queries_per_second",
+    "get_rows_fetched_per_second",
+    "get_statement_cache_hit_rate",
+    "get_open_cursors",
+    "get_memory_used",
+    "get_page_cache_hits_per_second",
+    "get_page_cache_misses_per_second",
+};
+
+static const int monitor_count = sizeof(monitor_names) / sizeof(monitor_names[0]);
+
+void DatabaseMonitorSQLite::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("_register_monitors"), &DatabaseMonitorSQLite::_register_monitors);
+    ClassDB::bind_method(D_METHOD("get_queries_per_second"), &DatabaseMonitorSQLite::get_queries_per_second);
+    ClassDB::bind_method(D_METHOD("get_rows_fetched_per_second"), &DatabaseMonitorSQLite::get_rows_fetched_per_second);
+    ClassDB::bind_method(D_METHOD("get_statement_cache_hit_rate"), &DatabaseMonitorSQLite::get_statement_cache_hit_rate);
+    ClassDB::bind_method(D_METHOD("get_open_cursors"), &DatabaseMonitorSQLite::get_open_cursors);
+    ClassDB::bind_method(D_METHOD("get_memory_used"), &DatabaseMonitorSQLite::get_memory_used);
+    ClassDB::bind_method(D_METHOD("get_page_cache_hits_per_second"), &DatabaseMonitorSQLite::get_page_cache_hits_per_second);
+    ClassDB::bind_method(D_METHOD("get_page_cache_misses_per_second"), &DatabaseMonitorSQLite::get_page_cache_misses_per_second);
+}
+
+void DatabaseMonitorSQLite::_register_monitors()
+{
+    Performance *performance = Performance::get_singleton();
+    ERR_FAIL_COND_MSG(performance == nullptr, "Database monitors can't be added without the Performance singleton.");
+
+    for(int i = 0; i < monitor_count; i++)
+    {
+        if(!performance->has_custom_monitor(monitor_names[i]))
+            performance->add_custom_monitor(monitor_names[i], Callable(this, monitor_methods[i]), Vector<Variant>());
+    }
+}
+
+void DatabaseMonitorSQLite::register_database(DatabaseSQLite *database)
+{
+    MutexLock lock(mutex);
+    databases.insert(database);
+}
+
+void DatabaseMonitorSQLite::unregister_database(DatabaseSQLite *database)
+{
+    MutexLock lock(mutex);
+    databases.erase(database);
+}
+
+// Adds the page cache hits and misses of db since the last call
+static void collect_page_cache(sqlite3 *db, uint64_t &hits, uint64_t &misses)
+{
+    int current, highwater;
+    if(sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_HIT, &current, &highwater, 1) == SQLITE_OK)
+        hits += current;
+    if(sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_MISS, &current, &highwater, 1) == SQLITE_OK)
+        misses += current;
+}
+
+void DatabaseMonitorSQLite::update_rates()
+{
+    MutexLock lock(mutex);
+
+    uint64_t now = OS::get_singleton()->get_ticks_usec();
+    if(window_start != 0 && now - window_start < 1000000)
+        return;
+
+    uint64_t page_hits = 0;
+    uint64_t page_misses = 0;
+    for(Set<DatabaseSQLite *>::Element *E = databases.front(); E; E = E->next())
+    {
+        DatabaseSQLite *database = E->get();
+        collect_page_cache(database->connection, page_hits, page_misses);
+
+        // Readers aren't thread safe, so only idle ones are read.
+        // The others are collected in a later window.
+        MutexLock reader_lock(database->mutex);
+        for(int i = 0; i < database->idle_readers.size(); i++)
+        {
+            collect_page_cache(database->idle_readers[i]->connection, page_hits, page_misses);
+        }
+    }
+
+    uint64_t queries = SQLiteActivity::queries;
+    uint64_t rows = SQLiteActivity::rows_fetched;
+
+    if(window_start != 0)
+    {
+        double seconds = (now - window_start) / 1000000.0;
+        queries_per_second = (queries - window_queries) / seconds;
+        rows_per_second = (rows - window_rows) / seconds;
+        page_hits_per_second = page_hits / seconds;
+        page_misses_per_second = page_misses / seconds;
+    }
+
+    window_start = now;
+    window_queries = queries;
+    window_rows = rows;
+}
+
+double DatabaseMonitorSQLite::get_queries_per_second()
+{
+    update_rates();
+    return queries_per_second;
+}
+
+double DatabaseMonitorSQLite::get_rows_fetched_per_second()
+{
+    update_rates();
+    return rows_per_second;
+}
+
+double DatabaseMonitorSQLite::get_page_cache_hits_per_second()
+{
+    update_rates();
+    return page_hits_per_second;
+}
+
+double DatabaseMonitorSQLite::get_page_cache_misses_per_second()
+{
+    update_rates();
+    return page_misses_per_second;
+}
+
+double DatabaseMonitorSQLite::get_statement_cache_hit_rate()
+{
+    MutexLock lock(mutex);
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    for(Set<DatabaseSQLite *>::Element *E = databases.front(); E; E = E->next())
+    {
+        DatabaseSQLite *database = E->get();
+        hits += database->statement_cache.get_hits();
+        misses += database->statement_cache.get_misses();
+        for(int i = 0; i < database->readers.size(); i++)
+        {
+            hits += database->readers[i]->statement_cache.get_hits();
+            misses += database->readers[i]->statement_cache.get_misses();
+        }
+    }
+
+    return hits + misses > 0 ? (double)hits / (hits + misses) : 0.0;
+}
+
+int64_t DatabaseMonitorSQLite::get_memory_used() const
+{
+    sqlite3_int64 current, highwater;
+    sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &current, &highwater, 0);
+    return current;
+}
+
+void DatabaseMonitorSQLite::profiler_toggle(void *userdata, bool enable, const Array &options)
+{
+    DatabaseMonitorSQLite *monitor = (DatabaseMonitorSQLite *)userdata;
+    monitor->frame_query_usec = SQLiteActivity::query_usec;
+    monitor->frame_queries = SQLiteActivity::queries;
+}
+
+void DatabaseMonitorSQLite::profiler_tick(void *userdata, float frame_time, float idle_time, float physics_time, float physics_frame_time)
+{
+    DatabaseMonitorSQLite *monitor = (DatabaseMonitorSQLite *)userdata;
+
+    uint64_t query_usec = SQLiteActivity::query_usec;
+    uint64_t queries = SQLiteActivity::queries;
+    uint64_t frame_usec = query_usec - monitor->frame_query_usec;
+    monitor->frame_query_usec = query_usec;
+    monitor->frame_queries = queries;
+
+    // Only sent while the debugger is profiling the servers,
+    // so the time shows up as its own server in the profiler
+    if(!EngineDebugger::is_profiling("servers"))
+        return;
+
+    Array data;
+    data.push_back("database");
+    data.push_back("query_time");
+    data.push_back(frame_usec / 1000000.0);
+    EngineDebugger::profiler_add_frame_data("servers", data);
+}
+
+DatabaseMonitorSQLite::DatabaseMonitorSQLite()
+{
+    singleton = this;
+
+    // The profiler ticks every frame, it only reports when the servers profiler is on
+    EngineDebugger::register_profiler("database", EngineDebugger::Profiler(this, profiler_toggle, nullptr, profiler_tick));
+    EngineDebugger::profiler_enable("database", true);
+
+    // Performance is created after the modules are registered
+    call_deferred("_register_monitors");
+}
+
+DatabaseMonitorSQLite::~DatabaseMonitorSQLite()
+{
+    if(EngineDebugger::has_profiler("database"))
+        EngineDebugger::unregister_profiler("database");
+
+    Performance *performance = Performance::get_singleton();
+    for(int i = 0; performance != nullptr && i < monitor_count; i++)
+    {
+        if(performance->has_custom_monitor(monitor_names[i]))
+            performance->remove_custom_monitor(monitor_names[i]);
+    }
+
+    singleton = nullptr;
+}
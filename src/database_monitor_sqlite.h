@@ -0,0 +1,88 @@
+#ifndef GODOT_DATABASE_MONITOR_SQLITE_H
+#define GODOT_DATABASE_MONITOR_SQLITE_H
+
+#include "core/object.h"
+#include "core/os/mutex.h"
+#include "core/safe_refcount.h"
+#include "core/set.h"
+
+class DatabaseSQLite;
+
+/// Process-wide counters of the activity of every SQLite database,
+/// updated by cursors and prepared statements from any thread
+struct SQLiteActivity
+{
+    static volatile uint64_t queries;
+    static volatile uint64_t rows_fetched;
+    static volatile uint64_t query_usec;
+    static volatile uint64_t open_cursors;
+
+    static void add_rows(uint64_t count) {atomic_add(&rows_fetched, count);}
+    static void add_query(uint64_t count, uint64_t usec) {atomic_add(&queries, count); atomic_add(&query_usec, usec);}
+};
+
+/// Adds the time until it goes out of scope to SQLiteActivity
+class SQLiteQueryTimer
+{
+    uint64_t start;
+    uint64_t count;
+
+    public:
+    SQLiteQueryTimer(uint64_t query_count = 1);
+    ~SQLiteQueryTimer();
+};
+
+/// Reports SQLite activity to the Performance custom monitors under
+/// "database/", and to the remote debugger's profiler as the
+/// "database" server, next to the physics and script time.
+class DatabaseMonitorSQLite : public Object
+{
+    GDCLASS(DatabaseMonitorSQLite, Object);
+
+    static DatabaseMonitorSQLite *singleton;
+
+    Mutex mutex;
+    Set<DatabaseSQLite *> databases; // Open databases, for their cache statistics
+
+    // Rates are measured over windows of at least a second
+    uint64_t window_start = 0;
+    uint64_t window_queries = 0;
+    uint64_t window_rows = 0;
+    double queries_per_second = 0.0;
+    double rows_per_second = 0.0;
+    double page_hits_per_second = 0.0;
+    double page_misses_per_second = 0.0;
+
+    uint64_t frame_query_usec = 0; // query_usec at the start of the frame
+    uint64_t frame_queries = 0;
+
+    void update_rates();
+
+    static void profiler_toggle(void *userdata, bool enable, const Array &options);
+    static void profiler_tick(void *userdata, float frame_time, float idle_time, float physics_time, float physics_frame_time);
+
+    protected:
+    static void _bind_methods();
+
+    /// Adds the Performance monitors, deferred until the Performance singleton exists
+    void _register_monitors();
+
+    public:
+    static DatabaseMonitorSQLite *get_singleton() {return singleton;}
+
+    void register_database(DatabaseSQLite *database);
+    void unregister_database(DatabaseSQLite *database);
+
+    double get_queries_per_second();
+    double get_rows_fetched_per_second();
+    double get_statement_cache_hit_rate();
+    int get_open_cursors() const {return (int)SQLiteActivity::open_cursors;}
+    int64_t get_memory_used() const;
+    double get_page_cache_hits_per_second();
+    double get_page_cache_misses_per_second();
+
+    DatabaseMonitorSQLite();
+    ~DatabaseMonitorSQLite();
+};
+
+#endif
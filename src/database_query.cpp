@@ -0,0 +1,73 @@
+#include "database_query.h"
+#include "database.h"
+
+void DatabaseQuery::_bind_methods()
+{
+    BIND_ENUM_CONSTANT(TYPE_EXECUTE);
+    BIND_ENUM_CONSTANT(TYPE_EXECUTE_MANY);
+    BIND_ENUM_CONSTANT(TYPE_COMMIT);
+    BIND_ENUM_CONSTANT(TYPE_ROLLBACK);
+
+    ClassDB::bind_method(D_METHOD("get_type"), &DatabaseQuery::get_type);
+    ClassDB::bind_method(D_METHOD("get_statement"), &DatabaseQuery::get_statement);
+    ClassDB::bind_method(D_METHOD("is_done"), &DatabaseQuery::is_done);
+    ClassDB::bind_method(D_METHOD("is_successful"), &DatabaseQuery::is_successful);
+    ClassDB::bind_method(D_METHOD("get_rows"), &DatabaseQuery::get_rows);
+    ClassDB::bind_method(D_METHOD("get_row_count"), &DatabaseQuery::get_row_count);
+
+    ADD_SIGNAL(MethodInfo("completed"));
+}
+
+DatabaseQuery::~DatabaseQuery()
+{
+}
+
+void DatabaseQuery::run()
+{
+    if(!database->is_open())
+    {
+        print_error("Database query failed, the database is not open!");
+        success = false;
+        return;
+    }
+
+    switch(type)
+    {
+        case TYPE_EXECUTE:
+        case TYPE_EXECUTE_MANY: {
+            Ref<Cursor> cursor = database->cursor();
+            if(cursor.is_null())
+            {
+                success = false;
+                return;
+            }
+
+            if(type == TYPE_EXECUTE)
+            {
+                success = cursor->execute(statement, arguments);
+                if(success)
+                    rows = cursor->fetch_all();
+            }
+            else
+            {
+                success = cursor->execute_many(statement, arguments);
+            }
+            row_count = cursor->get_row_count();
+            cursor->close();
+        } break;
+
+        case TYPE_COMMIT:
+            success = database->commit() == OK;
+            break;
+
+        case TYPE_ROLLBACK:
+            success = database->rollback() == OK;
+            break;
+    }
+}
+
+void DatabaseQuery::complete()
+{
+    state = STATE_DONE;
+    emit_signal("completed");
+}
@@ -0,0 +1,72 @@
+#ifndef GODOT_DATABASE_QUERY_H
+#define GODOT_DATABASE_QUERY_H
+
+#include "core/reference.h"
+#include "core/ustring.h"
+
+class Database;
+
+/// Handle to a database operation submitted to a DatabaseExecutor.
+///
+/// The "completed" signal is emitted on the main thread once the
+/// operation has finished. Results can only be read after that.
+class DatabaseQuery : public Reference {
+    GDCLASS(DatabaseQuery, Reference);
+    friend class Database;
+    friend class DatabaseExecutor;
+
+    protected:
+    static void _bind_methods();
+
+    enum State
+    {
+        STATE_PENDING,
+        STATE_RUNNING,
+        STATE_FINISHED, // Finished, but not reported on the main thread yet
+        STATE_DONE,
+    };
+
+    int type = TYPE_EXECUTE;
+    State state = STATE_PENDING;
+
+    Ref<Database> database;
+    String statement;
+    Array arguments;
+
+    bool success = false;
+    Array rows;
+    int row_count = -1;
+
+    /// Runs the operation on the calling thread
+    void run();
+
+    /// Marks the query as done and emits "completed"
+    void complete();
+
+    public:
+    static const int TYPE_EXECUTE = 0;
+    static const int TYPE_EXECUTE_MANY = 1;
+    static const int TYPE_COMMIT = 2;
+    static const int TYPE_ROLLBACK = 3;
+
+    int get_type() const {return type;}
+    String get_statement() const {return statement;}
+
+    /// Returns true once the "completed" signal has been emitted
+    bool is_done() const {return state == STATE_DONE;}
+
+    /// Returns true if the operation finished without errors.
+    bool is_successful() const {return success;}
+
+    /// Returns every row returned by an execute query, in the
+    /// row format of a new cursor.
+    Array get_rows() const {return rows;}
+
+    /// Returns the number of rows affected by an execute query,
+    /// or -1 if it couldn't be determined.
+    int get_row_count() const {return row_count;}
+
+    ~DatabaseQuery();
+};
+
+#endif
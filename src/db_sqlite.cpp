@@ -1,4 +1,9 @@
 #include "db_sqlite.h"
+#include "database_monitor_sqlite.h"
+#include "sqlite_pack_vfs.h"
+#include "core/io/json.h"
+#include "core/io/marshalls.h"
+#include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "editor/project_settings_editor.h"
 
@@ -12,11 +17,98 @@ void DatabaseSQLite::_bind_methods()
     BIND_ENUM_CONSTANT(OPEN_NOFOLLOW);
     BIND_ENUM_CONSTANT(OPEN_DEFAULT);
 
+    BIND_ENUM_CONSTANT(JOURNAL_MODE_DEFAULT);
+    BIND_ENUM_CONSTANT(JOURNAL_MODE_DELETE);
+    BIND_ENUM_CONSTANT(JOURNAL_MODE_TRUNCATE);
+    BIND_ENUM_CONSTANT(JOURNAL_MODE_PERSIST);
+    BIND_ENUM_CONSTANT(JOURNAL_MODE_MEMORY);
+    BIND_ENUM_CONSTANT(JOURNAL_MODE_WAL);
+    BIND_ENUM_CONSTANT(JOURNAL_MODE_OFF);
+
+    BIND_ENUM_CONSTANT(SYNCHRONOUS_DEFAULT);
+    BIND_ENUM_CONSTANT(SYNCHRONOUS_OFF);
+    BIND_ENUM_CONSTANT(SYNCHRONOUS_NORMAL);
+    BIND_ENUM_CONSTANT(SYNCHRONOUS_FULL);
+    BIND_ENUM_CONSTANT(SYNCHRONOUS_EXTRA);
+
+    BIND_ENUM_CONSTANT(TEMP_STORE_DEFAULT);
+    BIND_ENUM_CONSTANT(TEMP_STORE_FILE);
+    BIND_ENUM_CONSTANT(TEMP_STORE_MEMORY);
+
+    BIND_ENUM_CONSTANT(PROFILE_DEFAULT);
+    BIND_ENUM_CONSTANT(PROFILE_SAVE_GAME);
+    BIND_ENUM_CONSTANT(PROFILE_TELEMETRY);
+    BIND_ENUM_CONSTANT(PROFILE_READ_ONLY_ASSET);
+
     ClassDB::bind_method(D_METHOD("open", "path", "flags"), &DatabaseSQLite::open, OPEN_DEFAULT);
     ClassDB::bind_method(D_METHOD("get_filepath"), &DatabaseSQLite::get_filepath);
     ClassDB::bind_method(D_METHOD("set_auto_commit", "value"), &DatabaseSQLite::set_auto_commit);
     ClassDB::bind_method(D_METHOD("get_auto_commit"), &DatabaseSQLite::get_auto_commit);
     ADD_PROPERTY(PropertyInfo(Variant::BOOL, "auto_commit"), "set_auto_commit", "get_auto_commit");
+    ClassDB::bind_method(D_METHOD("set_execute_many_chunk_size", "value"), &DatabaseSQLite::set_execute_many_chunk_size);
+    ClassDB::bind_method(D_METHOD("get_execute_many_chunk_size"), &DatabaseSQLite::get_execute_many_chunk_size);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "execute_many_chunk_size", PROPERTY_HINT_RANGE, "0,100000,1,or_greater"), "set_execute_many_chunk_size", "get_execute_many_chunk_size");
+    ClassDB::bind_method(D_METHOD("set_statement_cache_size", "value"), &DatabaseSQLite::set_statement_cache_size);
+    ClassDB::bind_method(D_METHOD("get_statement_cache_size"), &DatabaseSQLite::get_statement_cache_size);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "statement_cache_size", PROPERTY_HINT_RANGE, "0,1024,1,or_greater"), "set_statement_cache_size", "get_statement_cache_size");
+    ClassDB::bind_method(D_METHOD("set_journal_mode", "value"), &DatabaseSQLite::set_journal_mode);
+    ClassDB::bind_method(D_METHOD("get_journal_mode"), &DatabaseSQLite::get_journal_mode);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "journal_mode", PROPERTY_HINT_ENUM, "Default,Delete,Truncate,Persist,Memory,WAL,Off"), "set_journal_mode", "get_journal_mode");
+    ClassDB::bind_method(D_METHOD("set_synchronous", "value"), &DatabaseSQLite::set_synchronous);
+    ClassDB::bind_method(D_METHOD("get_synchronous"), &DatabaseSQLite::get_synchronous);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "synchronous", PROPERTY_HINT_ENUM, "Default,Off,Normal,Full,Extra"), "set_synchronous", "get_synchronous");
+    ClassDB::bind_method(D_METHOD("set_cache_size", "value"), &DatabaseSQLite::set_cache_size);
+    ClassDB::bind_method(D_METHOD("get_cache_size"), &DatabaseSQLite::get_cache_size);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "cache_size", PROPERTY_HINT_RANGE, "0,1048576,1,or_greater"), "set_cache_size", "get_cache_size");
+    ClassDB::bind_method(D_METHOD("set_mmap_size", "value"), &DatabaseSQLite::set_mmap_size);
+    ClassDB::bind_method(D_METHOD("get_mmap_size"), &DatabaseSQLite::get_mmap_size);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "mmap_size", PROPERTY_HINT_RANGE, "0,1073741824,1,or_greater"), "set_mmap_size", "get_mmap_size");
+    ClassDB::bind_method(D_METHOD("set_temp_store", "value"), &DatabaseSQLite::set_temp_store);
+    ClassDB::bind_method(D_METHOD("get_temp_store"), &DatabaseSQLite::get_temp_store);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "temp_store", PROPERTY_HINT_ENUM, "Default,File,Memory"), "set_temp_store", "get_temp_store");
+    ClassDB::bind_method(D_METHOD("set_query_only", "value"), &DatabaseSQLite::set_query_only);
+    ClassDB::bind_method(D_METHOD("is_query_only"), &DatabaseSQLite::is_query_only);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "query_only"), "set_query_only", "is_query_only");
+    ClassDB::bind_method(D_METHOD("apply_profile", "profile"), &DatabaseSQLite::apply_profile);
+    ClassDB::bind_method(D_METHOD("set_busy_timeout", "value"), &DatabaseSQLite::set_busy_timeout);
+    ClassDB::bind_method(D_METHOD("get_busy_timeout"), &DatabaseSQLite::get_busy_timeout);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "busy_timeout", PROPERTY_HINT_RANGE, "0,60000,1,or_greater"), "set_busy_timeout", "get_busy_timeout");
+    ClassDB::bind_method(D_METHOD("get_last_error"), &DatabaseSQLite::get_last_error);
+    ClassDB::bind_method(D_METHOD("set_reader_count", "value"), &DatabaseSQLite::set_reader_count);
+    ClassDB::bind_method(D_METHOD("get_reader_count"), &DatabaseSQLite::get_reader_count);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "reader_count", PROPERTY_HINT_RANGE, "0,64,1,or_greater"), "set_reader_count", "get_reader_count");
+    ClassDB::bind_method(D_METHOD("open_blob", "table", "column", "row", "writable", "schema"), &DatabaseSQLite::open_blob, DEFVAL(false), DEFVAL("main"));
+    ClassDB::bind_method(D_METHOD("allocate_blob", "table", "column", "row", "size", "schema"), &DatabaseSQLite::allocate_blob, DEFVAL("main"));
+    ClassDB::bind_method(D_METHOD("spatial_index", "table", "dimensions"), &DatabaseSQLite::spatial_index, DEFVAL(3));
+    ClassDB::bind_method(D_METHOD("get_last_insert_rowid"), &DatabaseSQLite::get_last_insert_rowid);
+    ClassDB::bind_method(D_METHOD("serialize"), &DatabaseSQLite::serialize);
+    ClassDB::bind_method(D_METHOD("deserialize", "data", "read_only"), &DatabaseSQLite::deserialize, DEFVAL(false));
+    ClassDB::bind_method(D_METHOD("backup_to", "target", "pages_per_step"), &DatabaseSQLite::backup_to, DEFVAL(256));
+    ClassDB::bind_method(D_METHOD("is_backup_running"), &DatabaseSQLite::is_backup_running);
+    ClassDB::bind_method(D_METHOD("cancel_backup"), &DatabaseSQLite::cancel_backup);
+    ClassDB::bind_method(D_METHOD("_backup_finished", "id"), &DatabaseSQLite::_backup_finished);
+    ClassDB::bind_method(D_METHOD("get_statement_cache_stats"), &DatabaseSQLite::get_statement_cache_stats);
+    ClassDB::bind_method(D_METHOD("reset_statement_cache_stats"), &DatabaseSQLite::reset_statement_cache_stats);
+    ClassDB::bind_method(D_METHOD("set_profiling", "value"), &DatabaseSQLite::set_profiling);
+    ClassDB::bind_method(D_METHOD("is_profiling"), &DatabaseSQLite::is_profiling);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "profiling"), "set_profiling", "is_profiling");
+    ClassDB::bind_method(D_METHOD("get_query_stats"), &DatabaseSQLite::get_query_stats);
+    ClassDB::bind_method(D_METHOD("reset_query_stats"), &DatabaseSQLite::reset_query_stats);
+    ClassDB::bind_method(D_METHOD("set_slow_query_threshold", "value"), &DatabaseSQLite::set_slow_query_threshold);
+    ClassDB::bind_method(D_METHOD("get_slow_query_threshold"), &DatabaseSQLite::get_slow_query_threshold);
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "slow_query_threshold", PROPERTY_HINT_RANGE, "0,10000,0.1,or_greater"), "set_slow_query_threshold", "get_slow_query_threshold");
+    ClassDB::bind_method(D_METHOD("set_slow_query_log_size", "value"), &DatabaseSQLite::set_slow_query_log_size);
+    ClassDB::bind_method(D_METHOD("get_slow_query_log_size"), &DatabaseSQLite::get_slow_query_log_size);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "slow_query_log_size", PROPERTY_HINT_RANGE, "0,1024,1,or_greater"), "set_slow_query_log_size", "get_slow_query_log_size");
+    ClassDB::bind_method(D_METHOD("set_slow_query_log_path", "value"), &DatabaseSQLite::set_slow_query_log_path);
+    ClassDB::bind_method(D_METHOD("get_slow_query_log_path"), &DatabaseSQLite::get_slow_query_log_path);
+    ADD_PROPERTY(PropertyInfo(Variant::STRING, "slow_query_log_path", PROPERTY_HINT_FILE, "*.log,*.jsonl"), "set_slow_query_log_path", "get_slow_query_log_path");
+    ClassDB::bind_method(D_METHOD("get_slow_queries"), &DatabaseSQLite::get_slow_queries);
+    ClassDB::bind_method(D_METHOD("clear_slow_queries"), &DatabaseSQLite::clear_slow_queries);
+
+    ADD_SIGNAL(MethodInfo("backup_progress", PropertyInfo(Variant::INT, "remaining"), PropertyInfo(Variant::INT, "page_count")));
+    ADD_SIGNAL(MethodInfo("backup_completed", PropertyInfo(Variant::INT, "error")));
+    ADD_SIGNAL(MethodInfo("transaction_lost"));
 }
 
 bool DatabaseSQLite::is_open()
@@ -24,389 +116,2534 @@ bool DatabaseSQLite::is_open()
     return connection != nullptr;
 }
 
+DatabaseSQLite::~DatabaseSQLite()
+{
+    // Also unregisters the database from the monitor
+    if(is_open())
+        close();
+}
+
 void DatabaseSQLite::close()
 {
     ERR_FAIL_COND_MSG(!is_open(), "SQLite database is not open!");
 
+    if(DatabaseMonitorSQLite::get_singleton())
+        DatabaseMonitorSQLite::get_singleton()->unregister_database(this);
+
+    cancel_backup();
+    release_statements();
+
+    // interrupt() may be using the connections from another thread
+    MutexLock lock(mutex);
+    close_readers();
+
+    statement_cache.set_connection(nullptr);
+
     sqlite3_close_v2(connection);
     connection = nullptr;
+    in_transaction = false;
+    transaction_lost = false;
+    file_database = false;
+    deserialized_data = PackedByteArray();
 }
 
-sqlite3_stmt *prepare_statement(sqlite3* connection, const char *statement)
+void DatabaseSQLite::release_statements()
 {
-    sqlite3_stmt* stmt;
-    int err = sqlite3_prepare_v3(connection, statement, -1, 0, &stmt, nullptr);
-    if(err != SQLITE_OK)
     {
-        print_error(String("SQLite error: ") + sqlite3_errmsg(connection));
-        sqlite3_finalize(stmt);
-        return nullptr;
+        // Cursors in the middle of a streaming query still hold
+        // statements on this connection
+        MutexLock lock(mutex);
+        while(streaming_cursors.front())
+        {
+            streaming_cursors.front()->get()->release_statement();
+        }
+        while(prepared_statements.front())
+        {
+            prepared_statements.front()->get()->finalize_statement();
+        }
+        while(blob_streams.front())
+        {
+            blob_streams.front()->get()->close_blob();
+        }
     }
 
-    return stmt;
+    statement_cache.flush();
 }
 
-// Internally execute statement without affecting last results
-bool DatabaseSQLite::exec_statement(const char *statement)
+PackedByteArray DatabaseSQLite::serialize()
 {
-    sqlite3_stmt* stmt = prepare_statement(connection, statement);
-
-    if(stmt == nullptr)
-    {
-        return false;
-    }
-
-    int err;
-    do
-    {
-        err = sqlite3_step(stmt);
-    }
-    while(err == SQLITE_BUSY);
-
-    if(err != SQLITE_DONE)
+    PackedByteArray data;
+    ERR_FAIL_COND_V_MSG(!is_open(), data, "SQLite database is not open!");
+
+    // In-memory databases can be read without SQLite making its own copy first
+    sqlite3_int64 size = 0;
+    unsigned char *bytes = sqlite3_serialize(connection, "main", &size, SQLITE_SERIALIZE_NOCOPY);
+    bool copied = bytes == nullptr;
+    if(copied)
     {
-        print_error(String("SQLite error: ") + sqlite3_errmsg(connection));
-        sqlite3_finalize(stmt);
-        return false;
+        bytes = sqlite3_serialize(connection, "main", &size, 0);
+        ERR_FAIL_COND_V_MSG(bytes == nullptr, data, String("SQLite failed to serialize the database: ") + sqlite3_errmsg(connection));
     }
 
-    sqlite3_finalize(stmt);
-    return true;
-}
-
-void DatabaseSQLite::begin_transaction()
-{
-    bool success = exec_statement("BEGIN TRANSACTION");
-    ERR_FAIL_COND_MSG(!success, "SQLite failed to begin a new transaction");
-
-    in_transaction = true;
-}
-
-void DatabaseSQLite::commit()
-{
-    ERR_FAIL_COND_MSG(!is_open(), "SQLite database is not open!");
+    data.resize(size);
+    memcpy(data.ptrw(), bytes, size);
 
-    bool success = exec_statement("END TRANSACTION");
-    ERR_FAIL_COND_MSG(!success, "SQLite failed to end a transaction");
+    if(copied)
+        sqlite3_free(bytes);
 
-    in_transaction = false;
-    if(!auto_commit)
-        begin_transaction();
+    return data;
 }
 
-void DatabaseSQLite::rollback()
+bool DatabaseSQLite::deserialize(PackedByteArray data, bool read_only)
 {
-    ERR_FAIL_COND_MSG(!is_open(), "SQLite database is not open!");
+    ERR_FAIL_COND_V_MSG(data.empty(), false, "SQLite can't deserialize an empty database.");
 
-    bool success = exec_statement("ROLLBACK TRANSACTION");
-    ERR_FAIL_COND_MSG(!success, "SQLite failed to rollback a transaction");
-
-    in_transaction = false;
-    if(!auto_commit)
-        begin_transaction();
-}
+    if(!is_open() && !open(":memory:", OPEN_DEFAULT))
+        return false;
 
-void DatabaseSQLite::set_auto_commit(bool value)
-{
-    auto_commit = value;
+    ERR_FAIL_COND_V_MSG(!readers.empty(), false, "SQLite databases with reader connections can't be deserialized.");
+    ERR_FAIL_COND_V_MSG(is_backup_running(), false, "SQLite database can't be deserialized during a backup.");
 
-    if(connection != nullptr)
+    // The connection can't have statements or a transaction in progress
+    release_statements();
+    if(in_transaction)
     {
-        if(!auto_commit && !in_transaction)
-        {
-            begin_transaction();
-        }
-        else if(auto_commit && in_transaction)
-        {
-            commit();
-        }
+        exec_statement("ROLLBACK TRANSACTION");
+        in_transaction = false;
     }
-}
-
-bool DatabaseSQLite::open(String path, int flags)
-{
-    ERR_FAIL_COND_V_MSG(is_open(), false, "SQLite database is already open!");
-
-    path = path.strip_edges();
-
-    if(path.empty())
-        return false;
-    
-    // TODO: Packed res:// databases
 
-    if(!path.begins_with(":") && (flags & SQLITE_OPEN_MEMORY) == 0)
+    unsigned char *bytes;
+    unsigned int flags;
+    if(read_only)
     {
-        path = ProjectSettings::get_singleton()->globalize_path(path);
+        // SQLite never writes to a read-only database, so data can be used in place
+        bytes = (unsigned char *)data.ptr();
+        flags = SQLITE_DESERIALIZE_READONLY;
+    }
+    else
+    {
+        // SQLite has to own the memory of a database it can resize
+        bytes = (unsigned char *)sqlite3_malloc64(data.size());
+        ERR_FAIL_COND_V_MSG(bytes == nullptr, false, "SQLite failed to allocate memory for the database.");
+        memcpy(bytes, data.ptr(), data.size());
+        flags = SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE;
     }
 
-    int err = sqlite3_open_v2(path.utf8().get_data(), &connection, flags, nullptr);
+    int err = sqlite3_deserialize(connection, "main", bytes, data.size(), data.size(), flags);
 
     if(err != SQLITE_OK)
     {
-        print_error(String("An error occurred while opening an SQLite database: ") + sqlite3_errstr(err));
-        connection = nullptr;
-        return false;
+        // SQLite frees the memory of a failed FREEONCLOSE deserialize
+        print_error(String("SQLite failed to deserialize the database: ") + sqlite3_errmsg(connection));
+    }
+    else
+    {
+        deserialized_data = read_only ? data : PackedByteArray();
+        file_database = false;
     }
-
-    filepath = path;
 
     if(!auto_commit)
         begin_transaction();
 
-    return true;
+    return err == SQLITE_OK;
 }
 
-Ref<Cursor> DatabaseSQLite::cursor()
+void DatabaseSQLite::set_journal_mode(int value)
 {
-    ERR_FAIL_COND_V_MSG(!is_open(), Ref<CursorSQLite>(), "SQLite database is not open!");
-
-    Ref<CursorSQLite> new_cursor;
-    new_cursor.instance();
-    new_cursor->database = Ref(this);
+    ERR_FAIL_INDEX(value, JOURNAL_MODE_OFF + 1);
+    journal_mode = value;
+}
 
-    return new_cursor;
+void DatabaseSQLite::set_synchronous(int value)
+{
+    ERR_FAIL_INDEX(value, SYNCHRONOUS_EXTRA + 1);
+    synchronous = value;
 }
 
-bool CursorSQLite::callproc(String procname, Array arguments)
+void DatabaseSQLite::set_cache_size(int value)
 {
-    ERR_FAIL_V_MSG(false, "SQLite does not support stored procedures.");
+    ERR_FAIL_COND(value < 0);
+    cache_size = value;
 }
 
-Dictionary CursorSQLite::parse_row(sqlite3_stmt *stmt)
+void DatabaseSQLite::set_mmap_size(int64_t value)
 {
-    Dictionary row;
+    ERR_FAIL_COND(value < 0);
+    mmap_size = value;
+}
 
-    // Get column count
-    int col_count = sqlite3_column_count(stmt);
+void DatabaseSQLite::set_temp_store(int value)
+{
+    ERR_FAIL_INDEX(value, TEMP_STORE_MEMORY + 1);
+    temp_store = value;
+}
 
-    // Fetch all columns
-    for (int i = 0; i < col_count; i++)
+void DatabaseSQLite::apply_profile(int profile)
+{
+    switch(profile)
     {
-        // Key name
-        const char *col_name = sqlite3_column_name(stmt, i);
-        String key = String(col_name);
-
-        // Value type
-        int col_type = sqlite3_column_type(stmt, i);
+        case PROFILE_DEFAULT:
+            journal_mode = JOURNAL_MODE_DEFAULT;
+            synchronous = SYNCHRONOUS_DEFAULT;
+            cache_size = 0;
+            mmap_size = 0;
+            temp_store = TEMP_STORE_DEFAULT;
+            query_only = false;
+            break;
 
-        // Value
-        Variant value;
-        switch(col_type)
-        {
-            case SQLITE_INTEGER:
-                value = Variant(sqlite3_column_int(stmt, i));
-                break;
-            
-            case SQLITE_FLOAT:
-                value = Variant(sqlite3_column_double(stmt, i));
-                break;
-            
-            case SQLITE_TEXT: {
-                int size = sqlite3_column_bytes(stmt, i);
-                String str = String::utf8((const char *)sqlite3_column_text(stmt, i), size);
-                value = Variant(str);
-                break;
-            }
+        case PROFILE_SAVE_GAME:
+            journal_mode = JOURNAL_MODE_DELETE;
+            synchronous = SYNCHRONOUS_FULL;
+            cache_size = 0;
+            mmap_size = 0;
+            temp_store = TEMP_STORE_MEMORY;
+            query_only = false;
+            break;
 
-            case SQLITE_BLOB: {
-                PackedByteArray arr;
-                int size = sqlite3_column_bytes(stmt, i);
-                arr.resize(size);
-                memcpy((void *)arr.ptr(), sqlite3_column_blob(stmt, i), size);
-                value = Variant(arr);
-                break;
-            }
+        case PROFILE_TELEMETRY:
+            journal_mode = JOURNAL_MODE_WAL;
+            synchronous = SYNCHRONOUS_NORMAL;
+            cache_size = 16384;
+            mmap_size = 0;
+            temp_store = TEMP_STORE_MEMORY;
+            query_only = false;
+            break;
 
-            default:
-                break;
-        }
+        case PROFILE_READ_ONLY_ASSET:
+            // Nothing is written, so the journal and sync settings don't matter
+            journal_mode = JOURNAL_MODE_DEFAULT;
+            synchronous = SYNCHRONOUS_DEFAULT;
+            cache_size = 16384;
+            mmap_size = 256 * 1024 * 1024;
+            temp_store = TEMP_STORE_MEMORY;
+            query_only = true;
+            break;
 
-        // Set dictionary value
-        row[key] = value;
+        default:
+            ERR_FAIL_MSG("Unknown SQLite profile " + itos(profile));
     }
-    return row;
 }
 
-bool CursorSQLite::bind_parameters(sqlite3_stmt *stmt, Array arguments)
+bool DatabaseSQLite::apply_pragmas(sqlite3 *db, bool writer)
 {
-    int param_count = sqlite3_bind_parameter_count(stmt);
-    int arg_count = arguments.size();
-    if(param_count != arg_count)
+    static const char *journal_modes[] = {nullptr, "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"};
+    static const char *synchronous_modes[] = {nullptr, "OFF", "NORMAL", "FULL", "EXTRA"};
+
+    // Readers need the writer's database in WAL mode to not block it
+    int mode = reader_count > 0 ? JOURNAL_MODE_WAL : journal_mode;
+
+    String pragmas;
+    if(writer && mode != JOURNAL_MODE_DEFAULT)
+        pragmas += String("PRAGMA journal_mode=") + journal_modes[mode] + ";";
+    if(writer && synchronous != SYNCHRONOUS_DEFAULT)
+        pragmas += String("PRAGMA synchronous=") + synchronous_modes[synchronous] + ";";
+    if(cache_size > 0)
+        pragmas += "PRAGMA cache_size=-" + itos(cache_size) + ";"; // Negative sizes are in KiB
+    if(mmap_size > 0)
+        pragmas += "PRAGMA mmap_size=" + itos(mmap_size) + ";";
+    if(temp_store != TEMP_STORE_DEFAULT)
+        pragmas += "PRAGMA temp_store=" + itos(temp_store) + ";";
+    if(writer && query_only)
+        pragmas += "PRAGMA query_only=1;";
+
+    if(pragmas.empty())
+        return true;
+
+    // Some pragmas return a row, which sqlite3_exec() steps through
+    if(sqlite3_exec(db, pragmas.utf8().get_data(), nullptr, nullptr, nullptr) != SQLITE_OK)
     {
-        print_error("SQLite statement expected " + itos(param_count) + " arguments, got " + itos(arg_count));
+        print_error(String("SQLite failed to apply connection settings: ") + sqlite3_errmsg(db));
         return false;
     }
-    for(int i = 0; i < param_count; i++)
-    {
-        int retcode;
-
-        switch (arguments[i].get_type()) {
-        case Variant::Type::NIL:
-            retcode = sqlite3_bind_null(stmt, i + 1);
-            break;
-        case Variant::Type::BOOL:
-        case Variant::Type::INT:
-            retcode = sqlite3_bind_int(stmt, i + 1, (int)arguments[i]);
-            break;
-        case Variant::Type::FLOAT:
-            retcode = sqlite3_bind_double(stmt, i + 1, (double)arguments[i]);
-            break;
-        case Variant::Type::STRING:
-            retcode = sqlite3_bind_text(stmt, i + 1, String(arguments[i]).utf8().get_data(), -1, SQLITE_TRANSIENT);
-            break;
-        case Variant::Type::PACKED_BYTE_ARRAY:
-            retcode = sqlite3_bind_blob(stmt, i + 1, PackedByteArray(arguments[i]).ptr(), PackedByteArray(arguments[i]).size(), SQLITE_TRANSIENT);
-            break;
-        default:
-            print_error("SQLite was passed unhandled Variant with TYPE_* enum " + itos(arguments[i].get_type()) + ". Please serialize your object into a String or a PackedByteArray.\n");
-            return false;
-        }
-        
-        if (retcode != SQLITE_OK) {
-			print_error("SQLite query failed, an error occured while binding argument" + itos(i + 1) + " of " + itos(arg_count) + " (" + sqlite3_errstr(retcode) + ")");
-			return false;
-		}
-    }
-    
     return true;
 }
 
-bool CursorSQLite::execute(String statement, Array arguments)
+static int journal_mode_callback(void *userdata, int column_count, char **values, char **names)
 {
-    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite cursor is not open!");
+    if(column_count > 0 && values[0] != nullptr)
+        *(String *)userdata = String(values[0]).to_lower();
+    return 0;
+}
+
+// Returns the journal mode SQLite actually uses for the main database of db,
+// which can differ from the requested one, like for in-memory databases
+static String get_journal_mode_name(sqlite3 *db)
+{
+    String mode;
+    sqlite3_exec(db, "PRAGMA journal_mode", journal_mode_callback, &mode, nullptr);
+    return mode;
+}
 
-    sqlite3_stmt *stmt = prepare_statement(database->connection, statement.utf8().get_data());
+// Deadline of the statement running on this thread in ticks, 0 if it has none
+static thread_local uint64_t statement_deadline = 0;
+// True if the last statement interrupted on this thread ran past its deadline
+static thread_local bool deadline_expired = false;
 
-    if(!stmt)
+// Sets the deadline of the statements run on this thread until it goes out of scope
+struct StatementDeadline
+{
+    StatementDeadline(int timeout)
     {
-        return false;
+        statement_deadline = timeout > 0 ? OS::get_singleton()->get_ticks_usec() + (uint64_t)timeout * 1000 : 0;
+        deadline_expired = false;
     }
 
-    if(!bind_parameters(stmt, arguments))
+    ~StatementDeadline()
     {
-        sqlite3_finalize(stmt);
-        return false;
+        // Later interrupts on this thread aren't caused by this deadline
+        statement_deadline = 0;
+        deadline_expired = false;
     }
+};
 
-    last_result.clear();
-    result_pos = 0;
+// Holds a mutex from lock() until it goes out of scope, for locks that
+// are only needed on some paths
+struct OptionalLock
+{
+    Mutex *mutex = nullptr;
 
-    int err;
-    do
+    void lock(Mutex &p_mutex)
     {
-        err = sqlite3_step(stmt);
-
-        if(err == SQLITE_ROW)
-        {
-            last_result.append(parse_row(stmt));
-        }
-    } while(err == SQLITE_ROW);
+        mutex = &p_mutex;
+        mutex->lock();
+    }
 
-    if(err != SQLITE_DONE)
+    ~OptionalLock()
     {
-        print_error(String("SQLite error: ") + sqlite3_errmsg(database->connection));
+        if(mutex != nullptr)
+            mutex->unlock();
     }
+};
 
-    sqlite3_finalize(stmt);
-    
-    return err == SQLITE_DONE;
+#ifndef SQLITE_OMIT_PROGRESS_CALLBACK
+// Number of virtual machine instructions between deadline checks
+static const int progress_interval = 1000;
+
+static int progress_handler(void *userdata)
+{
+    if(statement_deadline != 0 && OS::get_singleton()->get_ticks_usec() >= statement_deadline)
+    {
+        deadline_expired = true;
+        return 1;
+    }
+    return 0;
 }
+#endif
 
-bool CursorSQLite::execute_many(String statement, Array arg_lists)
+// Lets statements on db be interrupted by their deadline
+static void set_progress_handler(sqlite3 *db)
 {
-    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite cursor is not open!");
+#ifndef SQLITE_OMIT_PROGRESS_CALLBACK
+    sqlite3_progress_handler(db, progress_interval, progress_handler, nullptr);
+#endif
+}
 
-    sqlite3_stmt *stmt = prepare_statement(database->connection, statement.utf8().get_data());
+void DatabaseSQLite::set_reader_count(int value)
+{
+    ERR_FAIL_COND(value < 0);
+    reader_count = value;
+}
 
-    last_result.clear();
-    result_pos = 0;
+bool DatabaseSQLite::open_readers(const String &path, int flags)
+{
+    // Readers are only ever used by one cursor at a time
+    int reader_flags = (flags & ~(SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)) | SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
 
-    for(int i = 0; i < arg_lists.size(); i++)
+    for(int i = 0; i < reader_count; i++)
     {
-        if(!bind_parameters(stmt, arg_lists[i]))
+        Reader *reader = memnew(Reader);
+        readers.push_back(reader);
+
+        int err = sqlite3_open_v2(path.utf8().get_data(), &reader->connection, reader_flags, nullptr);
+        if(err != SQLITE_OK)
         {
-            sqlite3_finalize(stmt);
+            print_error(String("An error occurred while opening an SQLite reader connection: ") + sqlite3_errstr(err));
             return false;
         }
 
-        int err;
-        do
-        {
-            err = sqlite3_step(stmt);
-        } while(err == SQLITE_ROW);
+        sqlite3_busy_handler(reader->connection, busy_handler, this);
+        set_progress_handler(reader->connection);
+        if(profiling)
+            query_stats.attach(reader->connection);
+        reader->profiling = profiling;
 
-        if(err != SQLITE_DONE)
-        {
-            print_error(String("SQLite error: ") + sqlite3_errmsg(database->connection));
-            sqlite3_finalize(stmt);
+        if(!apply_pragmas(reader->connection, false))
             return false;
-        }
 
-        sqlite3_reset(stmt);
+        reader->statement_cache.set_capacity(statement_cache.get_capacity());
+        reader->statement_cache.set_connection(reader->connection);
+        idle_readers.push_back(reader);
     }
 
     return true;
 }
 
-int CursorSQLite::get_row_count()
+void DatabaseSQLite::close_readers()
 {
-    return last_result.size();
+    MutexLock lock(mutex);
+    for(int i = 0; i < readers.size(); i++)
+    {
+        readers[i]->statement_cache.flush();
+        readers[i]->statement_cache.set_connection(nullptr);
+        sqlite3_close_v2(readers[i]->connection);
+        memdelete(readers[i]);
+    }
+    readers.clear();
+    idle_readers.clear();
+    read_only_statements.clear();
 }
 
-void CursorSQLite::scroll(int amount, bool absolute)
+DatabaseSQLite::Reader *DatabaseSQLite::acquire_reader()
 {
-    ERR_FAIL_COND_MSG(!is_open(), "SQLite cursor is not open!");
+    if(!sqlite3_get_autocommit(connection))
+        return nullptr;
 
-    if(absolute)
-    {
-        ERR_FAIL_COND(amount < 0);
-        ERR_FAIL_COND(amount >= get_row_count());
+    MutexLock lock(mutex);
+    if(idle_readers.empty())
+        return nullptr;
 
-        result_pos = amount;
-    }
-    else
-    {
-        ERR_FAIL_COND(result_pos + amount < 0);
-        ERR_FAIL_COND(result_pos + amount >= get_row_count());
+    Reader *reader = idle_readers[idle_readers.size() - 1];
+    idle_readers.resize(idle_readers.size() - 1);
+    return reader;
+}
 
-        result_pos += amount;
+void DatabaseSQLite::release_reader(Reader *reader)
+{
+    MutexLock lock(mutex);
+    update_reader(reader);
+    idle_readers.push_back(reader);
+}
+
+void DatabaseSQLite::update_reader(Reader *reader)
+{
+    if(reader->statement_cache.get_capacity() != statement_cache.get_capacity())
+        reader->statement_cache.set_capacity(statement_cache.get_capacity());
+
+    if(reader->profiling != profiling)
+    {
+        if(profiling)
+            query_stats.attach(reader->connection);
+        else
+            SQLiteQueryStats::detach(reader->connection);
+        reader->profiling = profiling;
     }
 }
 
-Dictionary CursorSQLite::fetch_one()
+bool DatabaseSQLite::find_read_only(const String &statement, bool &r_read_only)
 {
-    ERR_FAIL_COND_V_MSG(!is_open(), Dictionary(), "SQLite cursor is not open!");
+    MutexLock lock(mutex);
+    const bool *read_only = read_only_statements.getptr(statement);
+    if(read_only == nullptr)
+        return false;
 
-    if(result_pos + 1 > get_row_count())
-        return Dictionary();
-    
-    Dictionary row = last_result[result_pos];
-    result_pos += 1;
-    return row;
+    r_read_only = *read_only;
+    return true;
 }
 
-Array CursorSQLite::fetch_many(int size)
+void DatabaseSQLite::store_read_only(const String &statement, bool read_only)
 {
-    ERR_FAIL_COND_V_MSG(!is_open(), Array(), "SQLite cursor is not open!");
+    MutexLock lock(mutex);
+    // Keep the map bounded when statements are built with inlined values
+    if(read_only_statements.size() >= 1024)
+        read_only_statements.clear();
+    read_only_statements[statement] = read_only;
+}
 
-    Array rows;
-    if(result_pos >= last_result.size())
-        return rows;
+void DatabaseSQLite::register_streaming_cursor(CursorSQLite *cursor)
+{
+    MutexLock lock(mutex);
+    streaming_cursors.insert(cursor);
+    atomic_increment(&SQLiteActivity::open_cursors);
+}
 
-    rows = last_result.slice(result_pos, std::min(result_pos + size, last_result.size() - 1), 1, true);
-    result_pos = std::min(result_pos + size, last_result.size() - 1);
-    return rows;
+void DatabaseSQLite::unregister_streaming_cursor(CursorSQLite *cursor)
+{
+    MutexLock lock(mutex);
+    cursor->interrupted = false;
+    if(streaming_cursors.erase(cursor))
+        atomic_decrement(&SQLiteActivity::open_cursors);
 }
 
-Array CursorSQLite::fetch_all()
+void DatabaseSQLite::unregister_prepared_statement(PreparedStatementSQLite *statement)
 {
-    ERR_FAIL_COND_V_MSG(!is_open(), Array(), "SQLite cursor is not open!");
+    MutexLock lock(mutex);
+    prepared_statements.erase(statement);
+}
 
-    Array rows;
-    if(result_pos >= get_row_count())
-        return rows;
-    
-    rows = last_result.slice(result_pos, last_result.size() - 1, 1, true);
-    result_pos = last_result.size() - 1;
-    return rows;
+void DatabaseSQLite::unregister_blob_stream(BlobStreamSQLite *blob)
+{
+    MutexLock lock(mutex);
+    blob_streams.erase(blob);
+}
+
+// Returns the Error matching an SQLite result code
+static Error sqlite_error(int code)
+{
+    switch(code & 0xff) // Ignore extended result codes
+    {
+        case SQLITE_OK:
+        case SQLITE_ROW:
+        case SQLITE_DONE:
+            return OK;
+        case SQLITE_BUSY:
+        case SQLITE_LOCKED:
+            return ERR_BUSY;
+        case SQLITE_INTERRUPT:
+            return deadline_expired ? ERR_TIMEOUT : ERR_SKIP;
+        default:
+            return ERR_QUERY_FAILED;
+    }
+}
+
+// Prints the error of a statement that failed to step
+// Returns the matching Error
+static Error step_error(sqlite3 *db, int code)
+{
+    Error error = sqlite_error(code);
+    if(error == ERR_SKIP)
+        return error; // Interrupted on purpose
+    if(error == ERR_TIMEOUT)
+        WARN_PRINT("SQLite statement ran past its timeout and was interrupted.");
+    else if(error == ERR_BUSY)
+        print_error(String("SQLite database is locked, the busy timeout expired: ") + sqlite3_errmsg(db));
+    else
+        print_error(String("SQLite error: ") + sqlite3_errmsg(db));
+    return error;
+}
+
+// Delays between retries of a locked database, in milliseconds
+static const int busy_delays[] = {1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100};
+static const int busy_delay_count = sizeof(busy_delays) / sizeof(busy_delays[0]);
+
+int DatabaseSQLite::busy_handler(void *userdata, int count)
+{
+    int timeout = ((DatabaseSQLite *)userdata)->busy_timeout;
+
+    // The time already waited for this lock, the first delays
+    // increase and the rest are all the longest delay
+    int delay = busy_delays[MIN(count, busy_delay_count - 1)];
+    int waited = 0;
+    for(int i = 0; i < MIN(count, busy_delay_count); i++)
+    {
+        waited += busy_delays[i];
+    }
+    if(count > busy_delay_count)
+        waited += (count - busy_delay_count) * busy_delays[busy_delay_count - 1];
+
+    if(waited >= timeout)
+        return 0;
+
+    // Sleep instead of spinning so other threads, and the
+    // connection holding the lock, get the core
+    OS::get_singleton()->delay_usec(MIN(delay, timeout - waited) * 1000);
+    return 1;
+}
+
+Error DatabaseSQLite::get_last_error()
+{
+    MutexLock lock(mutex);
+    return last_error;
+}
+
+void DatabaseSQLite::set_busy_timeout(int value)
+{
+    ERR_FAIL_COND(value < 0);
+    busy_timeout = value;
+}
+
+// Internally execute statement without affecting last results
+Error DatabaseSQLite::exec_statement(const char *statement)
+{
+    String sql = statement;
+    sqlite3_stmt* stmt = statement_cache.acquire(sql);
+
+    if(stmt == nullptr)
+        return sqlite_error(sqlite3_errcode(connection));
+
+    // Locks are waited on by the busy handler
+    int err = sqlite3_step(stmt);
+
+    Error error = err == SQLITE_DONE ? OK : step_error(connection, err);
+    statement_cache.release(sql, stmt);
+    return error;
+}
+
+Error DatabaseSQLite::begin_batch()
+{
+    return exec_statement("SAVEPOINT execute_many");
+}
+
+Error DatabaseSQLite::end_batch(bool success)
+{
+    if(!success)
+    {
+        // Undo every row of the batch, then discard the savepoint
+        exec_statement("ROLLBACK TO execute_many");
+    }
+
+    return exec_statement("RELEASE execute_many");
+}
+
+void DatabaseSQLite::set_execute_many_chunk_size(int value)
+{
+    ERR_FAIL_COND(value < 0);
+    execute_many_chunk_size = value;
+}
+
+void DatabaseSQLite::set_statement_cache_size(int value)
+{
+    statement_cache.set_capacity(value);
+
+    // Busy readers pick up the new size when they're released
+    MutexLock lock(mutex);
+    for(int i = 0; i < idle_readers.size(); i++)
+    {
+        update_reader(idle_readers[i]);
+    }
+}
+
+Dictionary DatabaseSQLite::get_statement_cache_stats() const
+{
+    int size = statement_cache.get_size();
+    uint64_t hits = statement_cache.get_hits();
+    uint64_t misses = statement_cache.get_misses();
+    uint64_t evictions = statement_cache.get_evictions();
+    for(int i = 0; i < readers.size(); i++)
+    {
+        size += readers[i]->statement_cache.get_size();
+        hits += readers[i]->statement_cache.get_hits();
+        misses += readers[i]->statement_cache.get_misses();
+        evictions += readers[i]->statement_cache.get_evictions();
+    }
+
+    Dictionary stats;
+    stats["size"] = size;
+    stats["hits"] = hits;
+    stats["misses"] = misses;
+    stats["evictions"] = evictions;
+    return stats;
+}
+
+void DatabaseSQLite::reset_statement_cache_stats()
+{
+    statement_cache.reset_counters();
+    for(int i = 0; i < readers.size(); i++)
+    {
+        readers[i]->statement_cache.reset_counters();
+    }
+}
+
+void DatabaseSQLite::set_profiling(bool value)
+{
+    MutexLock lock(mutex);
+    profiling = value;
+
+    if(connection == nullptr)
+        return;
+
+    if(profiling)
+        query_stats.attach(connection);
+    else
+        SQLiteQueryStats::detach(connection);
+
+    // Busy readers pick up the setting when they're released
+    for(int i = 0; i < idle_readers.size(); i++)
+    {
+        update_reader(idle_readers[i]);
+    }
+}
+
+Array DatabaseSQLite::get_query_stats()
+{
+    return query_stats.get_stats();
+}
+
+void DatabaseSQLite::reset_query_stats()
+{
+    query_stats.reset();
+}
+
+void DatabaseSQLite::set_slow_query_threshold(float value)
+{
+    ERR_FAIL_COND(value < 0.0);
+    slow_query_threshold = value;
+}
+
+void DatabaseSQLite::set_slow_query_log_size(int value)
+{
+    ERR_FAIL_COND(value < 0);
+
+    MutexLock lock(mutex);
+    slow_query_log_size = value;
+    while(slow_queries.size() > slow_query_log_size)
+    {
+        slow_queries.pop_front();
+    }
+}
+
+String DatabaseSQLite::explain_query_plan(const String &statement)
+{
+    sqlite3_stmt *stmt;
+    int err = sqlite3_prepare_v2(connection, ("EXPLAIN QUERY PLAN " + statement).utf8().get_data(), -1, &stmt, nullptr);
+    if(err != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return String();
+    }
+
+    // Rows are (id, parent, notused, detail), children come after their parent
+    HashMap<int, int> depths;
+    String plan;
+    while(sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        int id = sqlite3_column_int(stmt, 0);
+        int parent = sqlite3_column_int(stmt, 1);
+        const int *parent_depth = depths.getptr(parent);
+        int depth = parent_depth != nullptr ? *parent_depth + 1 : 0;
+        depths.set(id, depth);
+
+        if(!plan.empty())
+            plan += "\n";
+        for(int i = 0; i < depth; i++)
+        {
+            plan += "  ";
+        }
+        plan += String::utf8((const char *)sqlite3_column_text(stmt, 3));
+    }
+
+    sqlite3_finalize(stmt);
+    return plan;
+}
+
+void DatabaseSQLite::log_slow_query(const String &statement, const Array &arguments, int batch_size, uint64_t usec)
+{
+    Dictionary entry;
+    entry["statement"] = statement;
+    entry["arguments"] = arguments.duplicate();
+    entry["batch_size"] = batch_size;
+    entry["usec"] = usec;
+    entry["plan"] = explain_query_plan(statement);
+    entry["time"] = OS::get_singleton()->get_unix_time();
+
+    String path;
+    String line;
+    {
+        MutexLock lock(mutex);
+
+        if(slow_query_log_size > 0)
+        {
+            slow_queries.push_back(entry);
+            while(slow_queries.size() > slow_query_log_size)
+            {
+                slow_queries.pop_front();
+            }
+        }
+
+        path = slow_query_log_path;
+        if(!path.empty())
+            line = JSON::print(entry);
+    }
+
+    if(path.empty())
+        return;
+
+    // The file is written without holding mutex, so a slow disk doesn't
+    // block commits, only other writes to the log
+    MutexLock lock(slow_query_file_mutex);
+    FileAccess *file = FileAccess::open(path, FileAccess::READ_WRITE);
+    if(file == nullptr)
+        file = FileAccess::open(path, FileAccess::WRITE);
+    ERR_FAIL_COND_MSG(file == nullptr, "SQLite can't open the slow query log " + path);
+
+    file->seek_end();
+    file->store_line(line);
+    memdelete(file);
+}
+
+Array DatabaseSQLite::get_slow_queries()
+{
+    MutexLock lock(mutex);
+
+    Array result;
+    for(List<Dictionary>::Element *E = slow_queries.front(); E; E = E->next())
+    {
+        result.append(E->get());
+    }
+    return result;
+}
+
+void DatabaseSQLite::clear_slow_queries()
+{
+    MutexLock lock(mutex);
+    slow_queries.clear();
+}
+
+void DatabaseSQLite::begin_transaction()
+{
+    MutexLock lock(operation_mutex);
+    Error err = exec_statement("BEGIN TRANSACTION");
+    ERR_FAIL_COND_MSG(err != OK, "SQLite failed to begin a new transaction");
+
+    in_transaction = true;
+}
+
+void DatabaseSQLite::recover_interrupt(Error error)
+{
+    if(error != ERR_SKIP && error != ERR_TIMEOUT)
+        return;
+
+    if(error == ERR_SKIP)
+    {
+        // SQLite interrupts every new statement on the connection until none
+        // are running, and streaming statements run until they are released.
+        // They may belong to other threads, so only their cursors release them.
+        MutexLock lock(mutex);
+        for(Set<CursorSQLite *>::Element *E = streaming_cursors.front(); E; E = E->next())
+        {
+            if(E->get()->reader == nullptr)
+                E->get()->interrupted = true;
+        }
+    }
+
+    // Only one cursor may restore the transaction it lost
+    bool expected = true;
+    if(!sqlite3_get_autocommit(connection) || !in_transaction.compare_exchange_strong(expected, false))
+        return;
+
+    WARN_PRINT("SQLite rolled back the current transaction, one of its statements was interrupted.");
+    call_deferred("emit_signal", "transaction_lost");
+
+    {
+        MutexLock lock(mutex);
+        transaction_lost = true;
+    }
+    resume_transaction();
+}
+
+void DatabaseSQLite::resume_transaction()
+{
+    {
+        MutexLock lock(mutex);
+        if(!transaction_lost)
+            return;
+
+        // BEGIN would be interrupted too while a flagged statement is running
+        for(Set<CursorSQLite *>::Element *E = streaming_cursors.front(); E; E = E->next())
+        {
+            if(E->get()->interrupted)
+                return;
+        }
+
+        transaction_lost = false;
+    }
+
+    if(!auto_commit && !in_transaction)
+        begin_transaction();
+}
+
+void DatabaseSQLite::interrupt()
+{
+    // close() can't release the connections in the meantime
+    MutexLock lock(mutex);
+    ERR_FAIL_COND_MSG(!is_open(), "SQLite database is not open!");
+
+    // sqlite3_interrupt() is safe to call while another thread uses the connection
+    sqlite3_interrupt(connection);
+
+    for(int i = 0; i < readers.size(); i++)
+    {
+        sqlite3_interrupt(readers[i]->connection);
+    }
+}
+
+Error DatabaseSQLite::commit()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), ERR_UNCONFIGURED, "SQLite database is not open!");
+    MutexLock operation_lock(operation_mutex);
+
+    Error err = exec_statement("END TRANSACTION");
+    {
+        MutexLock lock(mutex);
+        last_error = err;
+    }
+    ERR_FAIL_COND_V_MSG(err != OK, err, "SQLite failed to end a transaction");
+
+    in_transaction = false;
+    if(!auto_commit)
+        begin_transaction();
+
+    return OK;
+}
+
+Error DatabaseSQLite::rollback()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), ERR_UNCONFIGURED, "SQLite database is not open!");
+    MutexLock operation_lock(operation_mutex);
+
+    Error err = exec_statement("ROLLBACK TRANSACTION");
+    {
+        MutexLock lock(mutex);
+        last_error = err;
+    }
+    ERR_FAIL_COND_V_MSG(err != OK, err, "SQLite failed to rollback a transaction");
+
+    // The rollback may have undone schema changes
+    statement_cache.flush();
+
+    in_transaction = false;
+    if(!auto_commit)
+        begin_transaction();
+
+    return OK;
+}
+
+void DatabaseSQLite::set_auto_commit(bool value)
+{
+    auto_commit = value;
+
+    if(connection != nullptr)
+    {
+        if(!auto_commit && !in_transaction)
+        {
+            begin_transaction();
+        }
+        else if(auto_commit && in_transaction)
+        {
+            commit();
+        }
+    }
+}
+
+bool DatabaseSQLite::open(String path, int flags)
+{
+    ERR_FAIL_COND_V_MSG(is_open(), false, "SQLite database is already open!");
+
+    path = path.strip_edges();
+
+    if(path.empty())
+        return false;
+    
+    const char *vfs = nullptr;
+
+    if(sqlite_pack_vfs_is_packed(path))
+    {
+        // Packed databases are read in place, and can't be written to
+        if(flags & (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE))
+        {
+            WARN_PRINT("SQLite database " + path + " is stored in a pack, opening it read-only.");
+            flags = (flags & ~(SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)) | SQLITE_OPEN_READONLY;
+        }
+        vfs = SQLITE_PACK_VFS_NAME;
+    }
+    else if(!path.begins_with(":") && (flags & SQLITE_OPEN_MEMORY) == 0)
+    {
+        path = ProjectSettings::get_singleton()->globalize_path(path);
+    }
+
+    int err = sqlite3_open_v2(path.utf8().get_data(), &connection, flags, vfs);
+
+    if(err != SQLITE_OK)
+    {
+        print_error(String("An error occurred while opening an SQLite database: ") + sqlite3_errstr(err));
+        connection = nullptr;
+        return false;
+    }
+
+    filepath = path;
+    file_database = vfs == nullptr && (flags & SQLITE_OPEN_READWRITE) != 0 && !path.begins_with(":") && (flags & SQLITE_OPEN_MEMORY) == 0;
+    statement_cache.set_connection(connection);
+    sqlite3_busy_handler(connection, busy_handler, this);
+    set_progress_handler(connection);
+    if(profiling)
+        query_stats.attach(connection);
+
+    // Pragmas like journal_mode can't be changed inside a transaction
+    if(!apply_pragmas(connection, true))
+    {
+        close();
+        return false;
+    }
+
+    if(reader_count > 0)
+    {
+        if(path.begins_with(":") || (flags & SQLITE_OPEN_MEMORY) != 0 || (flags & SQLITE_OPEN_READWRITE) == 0)
+        {
+            WARN_PRINT("SQLite reader connections are only opened for writable database files.");
+        }
+        else if(get_journal_mode_name(connection) != "wal")
+        {
+            // Readers would block the writer in any other journal mode
+            WARN_PRINT("SQLite database " + path + " couldn't be switched to WAL journal mode, reader connections aren't opened.");
+        }
+        else if(!open_readers(path, flags))
+        {
+            close();
+            return false;
+        }
+        else if(!auto_commit)
+        {
+            WARN_PRINT("SQLite reader connections are only used with auto_commit enabled.");
+        }
+    }
+
+    if(!auto_commit)
+        begin_transaction();
+
+    if(DatabaseMonitorSQLite::get_singleton())
+        DatabaseMonitorSQLite::get_singleton()->register_database(this);
+
+    return true;
+}
+
+Ref<Cursor> DatabaseSQLite::cursor()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Ref<CursorSQLite>(), "SQLite database is not open!");
+
+    Ref<CursorSQLite> new_cursor;
+    new_cursor.instance();
+    new_cursor->database = Ref(this);
+
+    return new_cursor;
+}
+
+void CursorSQLite::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("set_streaming", "value"), &CursorSQLite::set_streaming);
+    ClassDB::bind_method(D_METHOD("is_streaming"), &CursorSQLite::is_streaming);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "streaming"), "set_streaming", "is_streaming");
+    ClassDB::bind_method(D_METHOD("get_last_error"), &CursorSQLite::get_last_error);
+    ClassDB::bind_method(D_METHOD("fetch_timed", "budget"), &CursorSQLite::fetch_timed);
+    ClassDB::bind_method(D_METHOD("set_timeout", "value"), &CursorSQLite::set_timeout);
+    ClassDB::bind_method(D_METHOD("get_timeout"), &CursorSQLite::get_timeout);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "timeout", PROPERTY_HINT_RANGE, "0,60000,1,or_greater"), "set_timeout", "get_timeout");
+
+    ADD_SIGNAL(MethodInfo("rows_available", PropertyInfo(Variant::ARRAY, "rows")));
+    ADD_SIGNAL(MethodInfo("finished", PropertyInfo(Variant::INT, "error")));
+}
+
+CursorSQLite::~CursorSQLite()
+{
+    release_statement();
+}
+
+void CursorSQLite::close()
+{
+    release_statement();
+    database = Ref<DatabaseSQLite>();
+}
+
+void CursorSQLite::release_statement()
+{
+    if(stmt == nullptr)
+        return;
+
+    release_to_cache(stmt_sql, stmt);
+    stmt = nullptr;
+    stmt_sql = String();
+    has_row = false;
+    database->unregister_streaming_cursor(this);
+}
+
+void CursorSQLite::release_to_cache(const String &sql, sqlite3_stmt *stmt)
+{
+    // The cache clears the statement's bindings, so their buffers can go
+    if(reader != nullptr)
+    {
+        reader->statement_cache.release(sql, stmt);
+        database->release_reader(reader);
+        reader = nullptr;
+    }
+    else
+    {
+        database->statement_cache.release(sql, stmt);
+    }
+    bindings.clear();
+}
+
+void CursorSQLite::check_interrupted()
+{
+    if(stmt == nullptr)
+        return;
+
+    {
+        MutexLock lock(database->mutex);
+        if(!interrupted)
+            return;
+    }
+
+    last_error = ERR_SKIP;
+    release_statement();
+    database->resume_transaction();
+}
+
+void CursorSQLite::advance_statement()
+{
+    int err = sqlite3_step(stmt);
+    if(err == SQLITE_ROW)
+    {
+        has_row = true;
+        return;
+    }
+
+    if(err != SQLITE_DONE)
+    {
+        last_error = step_error(sqlite3_db_handle(stmt), err);
+    }
+    release_statement();
+
+    if(last_error != OK)
+        database->recover_interrupt(last_error);
+}
+
+Ref<PreparedStatement> DatabaseSQLite::prepare(String statement)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Ref<PreparedStatementSQLite>(), "SQLite database is not open!");
+
+    sqlite3_stmt *stmt;
+    int err = sqlite3_prepare_v3(connection, statement.utf8().get_data(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+    if(err != SQLITE_OK)
+    {
+        print_error(String("SQLite error: ") + sqlite3_errmsg(connection));
+        sqlite3_finalize(stmt);
+        return Ref<PreparedStatementSQLite>();
+    }
+
+    Ref<PreparedStatementSQLite> new_statement;
+    new_statement.instance();
+    new_statement->database = Ref(this);
+    new_statement->stmt = stmt;
+
+    MutexLock lock(mutex);
+    prepared_statements.insert(new_statement.ptr());
+
+    return new_statement;
+}
+
+Ref<BlobStream> DatabaseSQLite::open_blob(String table, String column, int64_t row, bool writable, String schema)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Ref<BlobStreamSQLite>(), "SQLite database is not open!");
+
+    sqlite3_blob *blob;
+    int err = sqlite3_blob_open(connection, schema.utf8().get_data(), table.utf8().get_data(), column.utf8().get_data(), row, writable ? 1 : 0, &blob);
+    if(err != SQLITE_OK)
+    {
+        print_error(String("SQLite failed to open blob: ") + sqlite3_errmsg(connection));
+        sqlite3_blob_close(blob);
+        return Ref<BlobStreamSQLite>();
+    }
+
+    Ref<BlobStreamSQLite> new_blob;
+    new_blob.instance();
+    new_blob->database = Ref(this);
+    new_blob->blob = blob;
+    new_blob->writable = writable;
+
+    MutexLock lock(mutex);
+    blob_streams.insert(new_blob.ptr());
+
+    return new_blob;
+}
+
+Error DatabaseSQLite::allocate_blob(String table, String column, int64_t row, int64_t size, String schema)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), ERR_UNCONFIGURED, "SQLite database is not open!");
+    ERR_FAIL_COND_V(size < 0, ERR_INVALID_PARAMETER);
+
+    MutexLock operation_lock(operation_mutex);
+    String sql = "UPDATE \"" + schema.replace("\"", "\"\"") + "\".\"" + table.replace("\"", "\"\"") + "\" SET \"" + column.replace("\"", "\"\"") + "\" = ? WHERE rowid = ?";
+    sqlite3_stmt *stmt = statement_cache.acquire(sql);
+    if(stmt == nullptr)
+        return sqlite_error(sqlite3_errcode(connection));
+
+    // The blob is zero-filled by SQLite as pages are written
+    int err = sqlite3_bind_zeroblob64(stmt, 1, size);
+    if(err == SQLITE_OK)
+        err = sqlite3_bind_int64(stmt, 2, row);
+    if(err == SQLITE_OK)
+        err = sqlite3_step(stmt);
+
+    Error error = err == SQLITE_DONE ? OK : step_error(connection, err);
+    if(error == OK && sqlite3_changes(connection) == 0)
+        error = ERR_DOES_NOT_EXIST;
+
+    statement_cache.release(sql, stmt);
+    return error;
+}
+
+bool DatabaseSQLite::backup_to(Variant target, int pages_per_step)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite database is not open!");
+    ERR_FAIL_COND_V_MSG(is_backup_running(), false, "SQLite database is already running a backup.");
+    ERR_FAIL_COND_V(pages_per_step == 0, false);
+
+    sqlite3 *destination;
+    if(target.get_type() == Variant::STRING)
+    {
+        String path = ProjectSettings::get_singleton()->globalize_path(String(target).strip_edges());
+        int err = sqlite3_open_v2(path.utf8().get_data(), &backup_destination, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+        if(err != SQLITE_OK)
+        {
+            print_error(String("An error occurred while opening the SQLite backup destination: ") + sqlite3_errstr(err));
+            sqlite3_close_v2(backup_destination);
+            backup_destination = nullptr;
+            return false;
+        }
+        destination = backup_destination;
+    }
+    else
+    {
+        backup_target = Ref<DatabaseSQLite>(Object::cast_to<DatabaseSQLite>(target));
+        ERR_FAIL_COND_V_MSG(backup_target.is_null() || !backup_target->is_open(), false, "SQLite backups need a path or an open DatabaseSQLite as target.");
+        ERR_FAIL_COND_V_MSG(backup_target.ptr() == this, false, "SQLite database can't be backed up to itself.");
+        destination = backup_target->connection;
+    }
+
+    // Reading from the writer would copy its uncommitted changes
+    sqlite3 *source = connection;
+    if(file_database)
+    {
+        int err = sqlite3_open_v2(filepath.utf8().get_data(), &backup_source_connection, SQLITE_OPEN_READONLY, nullptr);
+        if(err != SQLITE_OK)
+        {
+            print_error(String("An error occurred while opening the SQLite backup source: ") + sqlite3_errstr(err));
+            sqlite3_close_v2(backup_source_connection);
+            backup_source_connection = nullptr;
+            sqlite3_close_v2(backup_destination);
+            backup_destination = nullptr;
+            backup_target = Ref<DatabaseSQLite>();
+            return false;
+        }
+        source = backup_source_connection;
+    }
+
+    backup = sqlite3_backup_init(destination, "main", source, "main");
+    if(backup == nullptr)
+    {
+        // The destination can't have a read transaction open
+        print_error(String("SQLite failed to start a backup: ") + sqlite3_errmsg(destination));
+        sqlite3_close_v2(backup_source_connection);
+        backup_source_connection = nullptr;
+        sqlite3_close_v2(backup_destination);
+        backup_destination = nullptr;
+        backup_target = Ref<DatabaseSQLite>();
+        return false;
+    }
+
+    backup_source = Ref(this);
+    backup_pages_per_step = pages_per_step;
+    backup_cancelled = false;
+    backup_error = OK;
+    backup_id++;
+    backup_thread = Thread::create(backup_thread_func, this);
+    return true;
+}
+
+void DatabaseSQLite::backup_thread_func(void *userdata)
+{
+    DatabaseSQLite *database = (DatabaseSQLite *)userdata;
+
+    int err = SQLITE_OK;
+    uint64_t busy_since = 0;
+    while(!database->backup_cancelled)
+    {
+        // The source connection is only locked during a step
+        err = sqlite3_backup_step(database->backup, database->backup_pages_per_step);
+        database->call_deferred("emit_signal", "backup_progress", sqlite3_backup_remaining(database->backup), sqlite3_backup_pagecount(database->backup));
+
+        if(err == SQLITE_DONE)
+            break;
+
+        if(err == SQLITE_BUSY || err == SQLITE_LOCKED)
+        {
+            // Give up once a lock has been held for longer than busy_timeout
+            uint64_t now = OS::get_singleton()->get_ticks_msec();
+            if(busy_since == 0)
+                busy_since = now;
+            else if(now - busy_since > (uint64_t)database->busy_timeout)
+                break;
+        }
+        else if(err != SQLITE_OK)
+            break;
+        else
+            busy_since = 0;
+
+        // Let the connection serve other statements between steps
+        OS::get_singleton()->delay_usec(1000);
+    }
+
+    if(database->backup_cancelled)
+        database->backup_error = ERR_SKIP;
+    else if(err == SQLITE_BUSY || err == SQLITE_LOCKED)
+    {
+        print_error("SQLite backup failed, the source or destination stayed locked past the busy timeout.");
+        database->backup_error = ERR_BUSY;
+    }
+    else if(err != SQLITE_DONE)
+    {
+        print_error(String("SQLite backup failed: ") + sqlite3_errstr(err));
+        database->backup_error = ERR_QUERY_FAILED;
+    }
+
+    database->call_deferred("_backup_finished", database->backup_id);
+}
+
+void DatabaseSQLite::finish_backup()
+{
+    Thread::wait_to_finish(backup_thread);
+    memdelete(backup_thread);
+    backup_thread = nullptr;
+
+    // Finishing a cancelled backup rolls the destination back
+    sqlite3_backup_finish(backup);
+    backup = nullptr;
+    sqlite3_close_v2(backup_destination);
+    backup_destination = nullptr;
+    sqlite3_close_v2(backup_source_connection);
+    backup_source_connection = nullptr;
+    backup_target = Ref<DatabaseSQLite>();
+    backup_source = Ref<DatabaseSQLite>();
+}
+
+void DatabaseSQLite::_backup_finished(int id)
+{
+    // The backup may already have been finished by cancel_backup()
+    if(id != backup_id || !is_backup_running())
+        return;
+
+    // The signal handlers may free the database
+    Ref<DatabaseSQLite> self = backup_source;
+    finish_backup();
+    emit_signal("backup_completed", backup_error);
+}
+
+void DatabaseSQLite::cancel_backup()
+{
+    if(!is_backup_running())
+        return;
+
+    backup_cancelled = true;
+    finish_backup();
+
+    // Cancelling from close() must not run signal handlers in the middle of it
+    call_deferred("emit_signal", "backup_completed", backup_error);
+}
+
+Ref<SpatialIndexSQLite> DatabaseSQLite::spatial_index(String table, int dimensions)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Ref<SpatialIndexSQLite>(), "SQLite database is not open!");
+    ERR_FAIL_COND_V_MSG(dimensions != 2 && dimensions != 3, Ref<SpatialIndexSQLite>(), "SQLite spatial indexes have 2 or 3 dimensions.");
+    ERR_FAIL_COND_V(table.empty(), Ref<SpatialIndexSQLite>());
+
+    Ref<SpatialIndexSQLite> index;
+    index.instance();
+    index->database = Ref(this);
+    index->setup(table, dimensions);
+
+    String sql = "CREATE VIRTUAL TABLE IF NOT EXISTS \"" + table.replace("\"", "\"\"") + "\" USING rtree(id, min_x, max_x, min_y, max_y";
+    if(dimensions == 3)
+        sql += ", min_z, max_z";
+    sql += ")";
+
+    if(exec_statement(sql.utf8().get_data()) != OK)
+        return Ref<SpatialIndexSQLite>();
+
+    return index;
+}
+
+int64_t DatabaseSQLite::get_last_insert_rowid()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), 0, "SQLite database is not open!");
+
+    return sqlite3_last_insert_rowid(connection);
+}
+
+bool CursorSQLite::callproc(String procname, Array arguments)
+{
+    ERR_FAIL_V_MSG(false, "SQLite does not support stored procedures.");
+}
+
+// Returns true if the column was declared with the VARIANT type,
+// whose tagged blobs are Variants encoded by the bindings
+static bool is_variant_column(sqlite3_stmt *stmt, int i)
+{
+    const char *declared_type = sqlite3_column_decltype(stmt, i);
+    return declared_type != nullptr && String(declared_type).to_upper().find("VARIANT") != -1;
+}
+
+// Reads a single column of the current row as a Variant
+// Blobs are decoded back into Variants if decode_variants is true
+static Variant column_value(sqlite3_stmt *stmt, int i, bool decode_variants = false)
+{
+    switch(sqlite3_column_type(stmt, i))
+    {
+        case SQLITE_INTEGER:
+            return Variant((int64_t)sqlite3_column_int64(stmt, i));
+        
+        case SQLITE_FLOAT:
+            return Variant(sqlite3_column_double(stmt, i));
+        
+        case SQLITE_TEXT: {
+            int size = sqlite3_column_bytes(stmt, i);
+            return Variant(String::utf8((const char *)sqlite3_column_text(stmt, i), size));
+        }
+
+        case SQLITE_BLOB: {
+            if(decode_variants)
+            {
+                Variant value;
+                if(SQLiteBindings::decode((const uint8_t *)sqlite3_column_blob(stmt, i), sqlite3_column_bytes(stmt, i), value))
+                    return value;
+            }
+
+            PackedByteArray arr;
+            int size = sqlite3_column_bytes(stmt, i);
+            arr.resize(size);
+            memcpy((void *)arr.ptr(), sqlite3_column_blob(stmt, i), size);
+            return Variant(arr);
+        }
+
+        default:
+            return Variant();
+    }
+}
+
+void CursorSQLite::read_description(sqlite3_stmt *stmt)
+{
+    int col_count = sqlite3_column_count(stmt);
+
+    description.resize(col_count);
+    column_keys.resize(col_count);
+    variant_columns.resize(col_count);
+    for(int i = 0; i < col_count; i++)
+    {
+        String name = String::utf8(sqlite3_column_name(stmt, i));
+        description.set(i, name);
+        column_keys.write[i] = name;
+        variant_columns.write[i] = is_variant_column(stmt, i);
+    }
+}
+
+Variant CursorSQLite::parse_row(sqlite3_stmt *stmt)
+{
+    int col_count = column_keys.size();
+
+    if(row_format == ROW_FORMAT_ARRAY)
+    {
+        Array row;
+        row.resize(col_count);
+        for(int i = 0; i < col_count; i++)
+        {
+            row[i] = column_value(stmt, i, variant_columns[i]);
+        }
+        return row;
+    }
+
+    Dictionary row;
+    for(int i = 0; i < col_count; i++)
+    {
+        row[column_keys[i]] = column_value(stmt, i, variant_columns[i]);
+    }
+    return row;
+}
+
+// Accumulates the cells of one result column into a typed packed array
+struct ColumnBuffer
+{
+    enum Kind
+    {
+        KIND_UNKNOWN,
+        KIND_INT,
+        KIND_FLOAT,
+        KIND_STRING,
+        KIND_VARIANT,
+    };
+
+    Kind kind = KIND_UNKNOWN;
+    int pending_nulls = 0; // NULL cells seen before the kind was known
+    bool decode_variants = false; // True for VARIANT columns
+
+    PackedInt64Array ints;
+    PackedFloat64Array floats;
+    PackedStringArray strings;
+    Array variants;
+    PackedByteArray valid;
+
+    // Picks the kind from a declared column type, following SQLite's affinity rules
+    void set_kind_from_decltype(const char *declared_type)
+    {
+        if(declared_type == nullptr)
+            return;
+
+        String type = String(declared_type).to_upper();
+        if(type.find("INT") != -1)
+            set_kind(KIND_INT);
+        else if(type.find("CHAR") != -1 || type.find("CLOB") != -1 || type.find("TEXT") != -1)
+            set_kind(KIND_STRING);
+        else if(type.find("REAL") != -1 || type.find("FLOA") != -1 || type.find("DOUB") != -1)
+            set_kind(KIND_FLOAT);
+    }
+
+    void set_kind(Kind new_kind)
+    {
+        kind = new_kind;
+        for(int i = 0; i < pending_nulls; i++)
+        {
+            push_default();
+        }
+        pending_nulls = 0;
+    }
+
+    void push_default()
+    {
+        switch(kind)
+        {
+            case KIND_INT: ints.push_back(0); break;
+            case KIND_FLOAT: floats.push_back(0.0); break;
+            case KIND_STRING: strings.push_back(String()); break;
+            default: variants.push_back(Variant()); break;
+        }
+    }
+
+    void push_null()
+    {
+        valid.push_back(0);
+        if(kind == KIND_UNKNOWN)
+            pending_nulls++;
+        else
+            push_default();
+    }
+
+    void push_cell(sqlite3_stmt *stmt, int i)
+    {
+        int type = sqlite3_column_type(stmt, i);
+        if(type == SQLITE_NULL)
+        {
+            push_null();
+            return;
+        }
+
+        if(kind == KIND_UNKNOWN)
+        {
+            switch(type)
+            {
+                case SQLITE_INTEGER: set_kind(KIND_INT); break;
+                case SQLITE_FLOAT: set_kind(KIND_FLOAT); break;
+                case SQLITE_TEXT: set_kind(KIND_STRING); break;
+                default: set_kind(KIND_VARIANT); break;
+            }
+        }
+
+        // SQLite converts cells that don't match the column's kind
+        valid.push_back(1);
+        switch(kind)
+        {
+            case KIND_INT:
+                ints.push_back(sqlite3_column_int64(stmt, i));
+                break;
+            case KIND_FLOAT:
+                floats.push_back(sqlite3_column_double(stmt, i));
+                break;
+            case KIND_STRING:
+                strings.push_back(String::utf8((const char *)sqlite3_column_text(stmt, i), sqlite3_column_bytes(stmt, i)));
+                break;
+            default:
+                variants.push_back(column_value(stmt, i, decode_variants));
+                break;
+        }
+    }
+
+    void push_value(const Variant &value)
+    {
+        if(value.get_type() == Variant::NIL)
+        {
+            push_null();
+            return;
+        }
+
+        if(kind == KIND_UNKNOWN)
+        {
+            switch(value.get_type())
+            {
+                case Variant::INT: set_kind(KIND_INT); break;
+                case Variant::FLOAT: set_kind(KIND_FLOAT); break;
+                case Variant::STRING: set_kind(KIND_STRING); break;
+                default: set_kind(KIND_VARIANT); break;
+            }
+        }
+
+        valid.push_back(1);
+        switch(kind)
+        {
+            case KIND_INT: ints.push_back(value); break;
+            case KIND_FLOAT: floats.push_back(value); break;
+            case KIND_STRING: strings.push_back(value); break;
+            default: variants.push_back(value); break;
+        }
+    }
+
+    Variant get_column()
+    {
+        if(kind == KIND_UNKNOWN)
+            set_kind(KIND_VARIANT);
+
+        switch(kind)
+        {
+            case KIND_INT: return ints;
+            case KIND_FLOAT: return floats;
+            case KIND_STRING: return strings;
+            default: return variants;
+        }
+    }
+};
+
+Dictionary CursorSQLite::collect_columns(int size)
+{
+    PackedStringArray names;
+    Vector<ColumnBuffer> buffers;
+
+    if(streaming)
+    {
+        check_interrupted();
+        SQLiteQueryTimer timer(0);
+        if(has_row)
+        {
+            int col_count = description.size();
+            names = description;
+            buffers.resize(col_count);
+            for(int i = 0; i < col_count; i++)
+            {
+                buffers.write[i].set_kind_from_decltype(sqlite3_column_decltype(stmt, i));
+                buffers.write[i].decode_variants = variant_columns[i];
+            }
+
+            int row = 0;
+            for(; (size < 0 || row < size) && has_row; row++)
+            {
+                for(int i = 0; i < col_count; i++)
+                {
+                    buffers.write[i].push_cell(stmt, i);
+                }
+                advance_statement();
+            }
+            SQLiteActivity::add_rows(row);
+        }
+    }
+    else if(result_pos < last_result.size())
+    {
+        int end = size < 0 ? last_result.size() : std::min(result_pos + size, last_result.size());
+
+        int col_count = description.size();
+        names = description;
+        buffers.resize(col_count);
+
+        // Rows keep the format they were parsed in
+        for(; result_pos < end; result_pos++)
+        {
+            const Variant &row = last_result[result_pos];
+            if(row.get_type() == Variant::ARRAY)
+            {
+                Array values = row;
+                for(int i = 0; i < col_count; i++)
+                {
+                    buffers.write[i].push_value(values[i]);
+                }
+            }
+            else
+            {
+                Dictionary values = row;
+                for(int i = 0; i < col_count; i++)
+                {
+                    buffers.write[i].push_value(values[column_keys[i]]);
+                }
+            }
+        }
+    }
+
+    Array columns;
+    Array valid;
+    for(int i = 0; i < buffers.size(); i++)
+    {
+        columns.append(buffers.write[i].get_column());
+        valid.append(buffers[i].valid);
+    }
+
+    Dictionary result;
+    result["names"] = names;
+    result["columns"] = columns;
+    result["valid"] = valid;
+    return result;
+}
+
+bool CursorSQLite::bind_parameters(sqlite3_stmt *stmt, Array arguments)
+{
+    int param_count = sqlite3_bind_parameter_count(stmt);
+    int arg_count = arguments.size();
+    if(param_count != arg_count)
+    {
+        print_error("SQLite statement expected " + itos(param_count) + " arguments, got " + itos(arg_count));
+        return false;
+    }
+    for(int i = 0; i < param_count; i++)
+    {
+        int retcode = bindings.bind(stmt, i + 1, arguments[i]);
+
+        if (retcode == SQLITE_MISMATCH) {
+            return false;
+        }
+        if (retcode != SQLITE_OK) {
+			print_error("SQLite query failed, an error occured while binding argument" + itos(i + 1) + " of " + itos(arg_count) + " (" + sqlite3_errstr(retcode) + ")");
+			return false;
+		}
+    }
+    
+    return true;
+}
+
+bool CursorSQLite::step_batch_row(sqlite3_stmt *stmt)
+{
+    int err;
+    do
+    {
+        err = sqlite3_step(stmt);
+    } while(err == SQLITE_ROW);
+
+    if(err != SQLITE_DONE)
+    {
+        last_error = step_error(database->connection, err);
+        return false;
+    }
+
+    sqlite3_reset(stmt);
+    return true;
+}
+
+bool CursorSQLite::execute(String statement, Array arguments)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite cursor is not open!");
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    bool success;
+    {
+        StatementDeadline deadline(timeout);
+        success = execute_statement(statement, arguments);
+    }
+    uint64_t usec = OS::get_singleton()->get_ticks_usec() - start;
+
+    database->recover_interrupt(last_error);
+
+    // Streaming queries are only timed up to their first row
+    if(database->is_slow_query(usec))
+        database->log_slow_query(statement, arguments, 1, usec);
+
+    return success;
+}
+
+bool CursorSQLite::execute_statement(String statement, Array arguments)
+{
+    SQLiteQueryTimer timer;
+
+    release_statement();
+    last_result.clear();
+    result_pos = 0;
+    fetch_finished = false;
+    description.clear();
+    column_keys.clear();
+    variant_columns.clear();
+    last_error = OK;
+
+    SQLiteStatementCache &cache = database->statement_cache;
+    sqlite3_stmt *new_stmt = nullptr;
+
+    if(!database->readers.empty())
+    {
+        // Statements are classified on the writer only the first time they run
+        bool read_only;
+        if(!database->find_read_only(statement, read_only))
+        {
+            new_stmt = cache.acquire(statement);
+            if(!new_stmt)
+            {
+                last_error = sqlite_error(sqlite3_errcode(database->connection));
+                return false;
+            }
+
+            read_only = sqlite3_stmt_readonly(new_stmt);
+            database->store_read_only(statement, read_only);
+        }
+
+        if(read_only)
+            reader = database->acquire_reader();
+    }
+
+    if(reader != nullptr)
+    {
+        if(new_stmt != nullptr)
+            cache.release(statement, new_stmt);
+        new_stmt = reader->statement_cache.acquire(statement);
+
+        if(!new_stmt)
+        {
+            last_error = sqlite_error(sqlite3_errcode(reader->connection));
+            database->release_reader(reader);
+            reader = nullptr;
+            return false;
+        }
+    }
+    else if(new_stmt == nullptr)
+    {
+        new_stmt = cache.acquire(statement);
+        if(!new_stmt)
+        {
+            last_error = sqlite_error(sqlite3_errcode(database->connection));
+            return false;
+        }
+    }
+
+    // Statements on the writer can't run in the middle of another thread's batch or commit
+    OptionalLock operation_lock;
+    if(reader == nullptr)
+        operation_lock.lock(database->operation_mutex);
+
+    if(!bind_parameters(new_stmt, arguments))
+    {
+        last_error = ERR_INVALID_PARAMETER;
+        release_to_cache(statement, new_stmt);
+        return false;
+    }
+
+    read_description(new_stmt);
+
+    if(streaming)
+    {
+        // Only step to the first row, the rest are stepped by the fetch methods
+        stmt = new_stmt;
+        stmt_sql = statement;
+        database->register_streaming_cursor(this);
+
+        int err = sqlite3_step(stmt);
+        if(err == SQLITE_ROW)
+        {
+            has_row = true;
+            return true;
+        }
+
+        if(err != SQLITE_DONE)
+        {
+            last_error = step_error(sqlite3_db_handle(stmt), err);
+        }
+        release_statement();
+        return err == SQLITE_DONE;
+    }
+
+    int err;
+    do
+    {
+        err = sqlite3_step(new_stmt);
+
+        if(err == SQLITE_ROW)
+        {
+            last_result.append(parse_row(new_stmt));
+        }
+    } while(err == SQLITE_ROW);
+    SQLiteActivity::add_rows(last_result.size());
+
+    if(err != SQLITE_DONE)
+    {
+        last_error = step_error(sqlite3_db_handle(new_stmt), err);
+    }
+
+    release_to_cache(statement, new_stmt);
+    
+    return err == SQLITE_DONE;
+}
+
+bool CursorSQLite::execute_batch(String statement, int row_count, BindRowFunc bind_row, void *userdata)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite cursor is not open!");
+    SQLiteQueryTimer timer(row_count);
+
+    // The batch savepoint is shared by every cursor on the writer
+    MutexLock operation_lock(database->operation_mutex);
+
+    release_statement();
+    last_result.clear();
+    result_pos = 0;
+    fetch_finished = false;
+    description.clear();
+    column_keys.clear();
+    variant_columns.clear();
+    last_error = OK;
+
+    SQLiteStatementCache &cache = database->statement_cache;
+    sqlite3_stmt *many_stmt = cache.acquire(statement);
+
+    if(!many_stmt)
+    {
+        last_error = sqlite_error(sqlite3_errcode(database->connection));
+        return false;
+    }
+
+    // Chunks can only be committed if the batch isn't part of an outer transaction
+    int chunk_size = sqlite3_get_autocommit(database->connection) ? database->execute_many_chunk_size : 0;
+
+    last_error = database->begin_batch();
+    if(last_error != OK)
+    {
+        release_to_cache(statement, many_stmt);
+        return false;
+    }
+
+    for(int i = 0; i < row_count; i++)
+    {
+        if(!bind_row(this, many_stmt, i, userdata))
+            last_error = ERR_INVALID_PARAMETER;
+
+        if(last_error != OK || !step_batch_row(many_stmt))
+        {
+            database->end_batch(false);
+            release_to_cache(statement, many_stmt);
+            return false;
+        }
+
+        if(chunk_size > 0 && (i + 1) % chunk_size == 0 && i + 1 < row_count)
+        {
+            last_error = database->end_batch(true);
+            if(last_error == OK)
+                last_error = database->begin_batch();
+            if(last_error != OK)
+            {
+                release_to_cache(statement, many_stmt);
+                return false;
+            }
+        }
+    }
+
+    release_to_cache(statement, many_stmt);
+    last_error = database->end_batch(true);
+    return last_error == OK;
+}
+
+bool CursorSQLite::execute_many(String statement, Array arg_lists)
+{
+    BindRowFunc bind_argument_list = [](CursorSQLite *cursor, sqlite3_stmt *stmt, int row, void *userdata) {
+        const Array &arg_lists = *(const Array *)userdata;
+        return cursor->bind_parameters(stmt, arg_lists[row]);
+    };
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    bool success;
+    {
+        StatementDeadline deadline(timeout);
+        success = execute_batch(statement, arg_lists.size(), bind_argument_list, &arg_lists);
+    }
+    uint64_t usec = OS::get_singleton()->get_ticks_usec() - start;
+
+    if(database.is_valid())
+        database->recover_interrupt(last_error);
+
+    if(database.is_valid() && database->is_slow_query(usec))
+        database->log_slow_query(statement, arg_lists.empty() ? Array() : Array(arg_lists[0]), arg_lists.size(), usec);
+
+    return success;
+}
+
+// One parameter of execute_many_columns(), bound row by row
+// straight from its packed buffer
+struct ParameterColumn
+{
+    Variant::Type type = Variant::NIL;
+    int size = 0;
+
+    // Hold a reference to the packed data for the duration of the batch
+    PackedInt32Array ints32;
+    PackedInt64Array ints64;
+    PackedFloat32Array floats32;
+    PackedFloat64Array floats64;
+    PackedStringArray strings;
+    Array values;
+
+    bool set(const Variant &column)
+    {
+        type = column.get_type();
+        switch(type)
+        {
+            case Variant::PACKED_INT32_ARRAY: ints32 = column; size = ints32.size(); return true;
+            case Variant::PACKED_INT64_ARRAY: ints64 = column; size = ints64.size(); return true;
+            case Variant::PACKED_FLOAT32_ARRAY: floats32 = column; size = floats32.size(); return true;
+            case Variant::PACKED_FLOAT64_ARRAY: floats64 = column; size = floats64.size(); return true;
+            case Variant::PACKED_STRING_ARRAY: strings = column; size = strings.size(); return true;
+            case Variant::ARRAY: values = column; size = values.size(); return true;
+            default: return false;
+        }
+    }
+
+    int bind(SQLiteBindings &bindings, sqlite3_stmt *stmt, int index, int row) const
+    {
+        switch(type)
+        {
+            case Variant::PACKED_INT32_ARRAY:
+                return sqlite3_bind_int(stmt, index, ints32.ptr()[row]);
+            case Variant::PACKED_INT64_ARRAY:
+                return sqlite3_bind_int64(stmt, index, ints64.ptr()[row]);
+            case Variant::PACKED_FLOAT32_ARRAY:
+                return sqlite3_bind_double(stmt, index, floats32.ptr()[row]);
+            case Variant::PACKED_FLOAT64_ARRAY:
+                return sqlite3_bind_double(stmt, index, floats64.ptr()[row]);
+            case Variant::PACKED_STRING_ARRAY:
+                return bindings.bind_text(stmt, index, strings.ptr()[row]);
+            default:
+                return bindings.bind(stmt, index, values[row]);
+        }
+    }
+};
+
+bool CursorSQLite::execute_many_columns(String statement, Array columns)
+{
+    Vector<ParameterColumn> parameters;
+    parameters.resize(columns.size());
+
+    int row_count = 0;
+    for(int i = 0; i < columns.size(); i++)
+    {
+        ERR_FAIL_COND_V_MSG(!parameters.write[i].set(columns[i]), false, "SQLite execute_many_columns() expects packed arrays or Arrays, got TYPE_* enum " + itos(columns[i].get_type()) + " for argument " + itos(i + 1) + ".");
+
+        if(i == 0)
+            row_count = parameters[i].size;
+
+        ERR_FAIL_COND_V_MSG(parameters[i].size != row_count, false, "SQLite execute_many_columns() expects every column to have the same size.");
+    }
+
+    BindRowFunc bind_parameter_columns = [](CursorSQLite *cursor, sqlite3_stmt *stmt, int row, void *userdata) {
+        const Vector<ParameterColumn> &columns = *(const Vector<ParameterColumn> *)userdata;
+
+        // Checked before the first row is stepped, missing parameters would bind NULL
+        int param_count = sqlite3_bind_parameter_count(stmt);
+        if(row == 0 && param_count != columns.size())
+        {
+            print_error("SQLite statement expected " + itos(param_count) + " columns, got " + itos(columns.size()));
+            return false;
+        }
+
+        for(int i = 0; i < columns.size(); i++)
+        {
+            int retcode = columns[i].bind(cursor->bindings, stmt, i + 1, row);
+
+            if (retcode == SQLITE_MISMATCH) {
+                return false;
+            }
+            if (retcode != SQLITE_OK) {
+                print_error("SQLite query failed, an error occured while binding argument " + itos(i + 1) + " of row " + itos(row) + " (" + sqlite3_errstr(retcode) + ")");
+                return false;
+            }
+        }
+        return true;
+    };
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    bool success;
+    {
+        StatementDeadline deadline(timeout);
+        success = execute_batch(statement, row_count, bind_parameter_columns, &parameters);
+    }
+    uint64_t usec = OS::get_singleton()->get_ticks_usec() - start;
+
+    if(database.is_valid())
+        database->recover_interrupt(last_error);
+
+    if(database.is_valid() && database->is_slow_query(usec))
+    {
+        Array first_row;
+        for(int i = 0; i < columns.size() && row_count > 0; i++)
+        {
+            first_row.append(columns[i].get(0));
+        }
+        database->log_slow_query(statement, first_row, row_count, usec);
+    }
+
+    return success;
+}
+
+int CursorSQLite::get_row_count()
+{
+    // The size of a streamed result isn't known until it has been stepped through
+    if(streaming)
+        return -1;
+
+    return last_result.size();
+}
+
+void CursorSQLite::scroll(int amount, bool absolute)
+{
+    ERR_FAIL_COND_MSG(!is_open(), "SQLite cursor is not open!");
+
+    if(streaming)
+    {
+        check_interrupted();
+        ERR_FAIL_COND_MSG(absolute || amount < 0, "Streaming SQLite cursors can only scroll forward.");
+
+        SQLiteQueryTimer timer(0);
+        for(int i = 0; i < amount && has_row; i++)
+        {
+            advance_statement();
+        }
+        return;
+    }
+
+    if(absolute)
+    {
+        ERR_FAIL_COND(amount < 0);
+        ERR_FAIL_COND(amount >= get_row_count());
+
+        result_pos = amount;
+    }
+    else
+    {
+        ERR_FAIL_COND(result_pos + amount < 0);
+        ERR_FAIL_COND(result_pos + amount >= get_row_count());
+
+        result_pos += amount;
+    }
+}
+
+Variant CursorSQLite::fetch_one()
+{
+    Variant empty_row = row_format == ROW_FORMAT_ARRAY ? Variant(Array()) : Variant(Dictionary());
+    ERR_FAIL_COND_V_MSG(!is_open(), empty_row, "SQLite cursor is not open!");
+
+    if(streaming)
+    {
+        check_interrupted();
+        if(!has_row)
+            return empty_row;
+
+        SQLiteQueryTimer timer(0);
+        SQLiteActivity::add_rows(1);
+        Variant row = parse_row(stmt);
+        advance_statement();
+        return row;
+    }
+
+    if(result_pos + 1 > get_row_count())
+        return empty_row;
+    
+    Variant row = last_result[result_pos];
+    result_pos += 1;
+    return row;
+}
+
+Array CursorSQLite::fetch_many(int size)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Array(), "SQLite cursor is not open!");
+
+    Array rows;
+
+    if(streaming)
+    {
+        check_interrupted();
+        SQLiteQueryTimer timer(0);
+        for(int i = 0; i < size && has_row; i++)
+        {
+            rows.append(parse_row(stmt));
+            advance_statement();
+        }
+        SQLiteActivity::add_rows(rows.size());
+        return rows;
+    }
+
+    if(result_pos >= last_result.size())
+        return rows;
+
+    rows = last_result.slice(result_pos, std::min(result_pos + size, last_result.size() - 1), 1, true);
+    result_pos = std::min(result_pos + size, last_result.size() - 1);
+    return rows;
+}
+
+void CursorSQLite::set_streaming(bool value)
+{
+    if(value == streaming)
+        return;
+
+    // The live statement would otherwise keep its reader checked out
+    release_statement();
+    last_result.clear();
+    result_pos = 0;
+    streaming = value;
+}
+
+void CursorSQLite::set_timeout(int value)
+{
+    ERR_FAIL_COND(value < 0);
+#ifdef SQLITE_OMIT_PROGRESS_CALLBACK
+    if(value > 0)
+        WARN_PRINT("SQLite was built without the progress callback, statements can't time out.");
+#endif
+    timeout = value;
+}
+
+Array CursorSQLite::fetch_timed(float budget)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Array(), "SQLite cursor is not open!");
+    ERR_FAIL_COND_V(budget < 0.0, Array());
+
+    Array rows;
+    uint64_t deadline = OS::get_singleton()->get_ticks_usec() + (uint64_t)(budget * 1000.0);
+
+    if(streaming)
+    {
+        check_interrupted();
+        SQLiteQueryTimer timer(0);
+        while(has_row)
+        {
+            rows.append(parse_row(stmt));
+            advance_statement();
+
+            if(OS::get_singleton()->get_ticks_usec() >= deadline)
+                break;
+        }
+        SQLiteActivity::add_rows(rows.size());
+    }
+    else
+    {
+        while(result_pos < last_result.size())
+        {
+            rows.append(last_result[result_pos]);
+            result_pos++;
+
+            if(OS::get_singleton()->get_ticks_usec() >= deadline)
+                break;
+        }
+    }
+
+    if(!rows.empty())
+        emit_signal("rows_available", rows);
+
+    bool exhausted = streaming ? !has_row : result_pos >= last_result.size();
+    if(exhausted && !fetch_finished)
+    {
+        fetch_finished = true;
+        emit_signal("finished", last_error);
+    }
+
+    return rows;
+}
+
+Array CursorSQLite::fetch_all()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Array(), "SQLite cursor is not open!");
+
+    Array rows;
+
+    if(streaming)
+    {
+        check_interrupted();
+        SQLiteQueryTimer timer(0);
+        while(has_row)
+        {
+            rows.append(parse_row(stmt));
+            advance_statement();
+        }
+        SQLiteActivity::add_rows(rows.size());
+        return rows;
+    }
+
+    if(result_pos >= get_row_count())
+        return rows;
+    
+    rows = last_result.slice(result_pos, last_result.size() - 1, 1, true);
+    result_pos = last_result.size() - 1;
+    return rows;
+}
+
+Dictionary CursorSQLite::fetch_columns_many(int size)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Dictionary(), "SQLite cursor is not open!");
+    ERR_FAIL_COND_V(size < 0, Dictionary());
+
+    return collect_columns(size);
+}
+
+Dictionary CursorSQLite::fetch_columns()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), Dictionary(), "SQLite cursor is not open!");
+
+    return collect_columns(-1);
+}
+
+PreparedStatementSQLite::~PreparedStatementSQLite()
+{
+    finalize_statement();
+}
+
+void PreparedStatementSQLite::finalize_statement()
+{
+    if(stmt == nullptr)
+        return;
+
+    sqlite3_finalize(stmt);
+    stmt = nullptr;
+    has_row = false;
+    bindings.clear();
+    database->unregister_prepared_statement(this);
+}
+
+void PreparedStatementSQLite::close()
+{
+    finalize_statement();
+    database = Ref<DatabaseSQLite>();
+}
+
+String PreparedStatementSQLite::get_sql()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), String(), "SQLite prepared statement is not open!");
+
+    return String::utf8(sqlite3_sql(stmt));
+}
+
+int PreparedStatementSQLite::get_parameter_count()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), 0, "SQLite prepared statement is not open!");
+
+    return sqlite3_bind_parameter_count(stmt);
+}
+
+int PreparedStatementSQLite::get_parameter_index(String name)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), -1, "SQLite prepared statement is not open!");
+
+    int index = sqlite3_bind_parameter_index(stmt, name.utf8().get_data());
+
+    // Allow the name to be given without its prefix
+    static const char *prefixes[] = {":", "@", "$"};
+    for(int i = 0; index == 0 && i < 3; i++)
+    {
+        index = sqlite3_bind_parameter_index(stmt, (prefixes[i] + name).utf8().get_data());
+    }
+
+    return index - 1;
+}
+
+bool PreparedStatementSQLite::bind(int index, Variant value)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite prepared statement is not open!");
+    ERR_FAIL_INDEX_V(index, sqlite3_bind_parameter_count(stmt), false);
+
+    // Bindings can't change until the statement has been reset
+    sqlite3_reset(stmt);
+    has_row = false;
+
+    int retcode = bindings.bind(stmt, index + 1, value);
+    if(retcode == SQLITE_MISMATCH)
+        return false;
+
+    ERR_FAIL_COND_V_MSG(retcode != SQLITE_OK, false, "SQLite failed to bind parameter " + itos(index) + " (" + sqlite3_errstr(retcode) + ")");
+    return true;
+}
+
+bool PreparedStatementSQLite::bind_named(String name, Variant value)
+{
+    int index = get_parameter_index(name);
+    ERR_FAIL_COND_V_MSG(index < 0, false, "SQLite statement has no parameter named " + name);
+
+    return bind(index, value);
+}
+
+bool PreparedStatementSQLite::bind_all(Array arguments)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite prepared statement is not open!");
+
+    int param_count = sqlite3_bind_parameter_count(stmt);
+    ERR_FAIL_COND_V_MSG(arguments.size() != param_count, false, "SQLite statement expected " + itos(param_count) + " arguments, got " + itos(arguments.size()));
+
+    for(int i = 0; i < param_count; i++)
+    {
+        if(!bind(i, arguments[i]))
+            return false;
+    }
+    return true;
+}
+
+void PreparedStatementSQLite::clear_bindings()
+{
+    ERR_FAIL_COND_MSG(!is_open(), "SQLite prepared statement is not open!");
+
+    sqlite3_reset(stmt);
+    has_row = false;
+    sqlite3_clear_bindings(stmt);
+    bindings.clear();
+}
+
+int PreparedStatementSQLite::step()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), STEP_ERROR, "SQLite prepared statement is not open!");
+
+    // Only the first step of an execution counts as a query
+    SQLiteQueryTimer timer(sqlite3_stmt_busy(stmt) ? 0 : 1);
+    int err = sqlite3_step(stmt);
+    has_row = err == SQLITE_ROW;
+
+    if(err == SQLITE_ROW)
+        return STEP_ROW;
+
+    if(err == SQLITE_DONE)
+        return STEP_DONE;
+
+    return step_error(database->connection, err) == ERR_BUSY ? STEP_BUSY : STEP_ERROR;
+}
+
+void PreparedStatementSQLite::reset()
+{
+    ERR_FAIL_COND_MSG(!is_open(), "SQLite prepared statement is not open!");
+
+    sqlite3_reset(stmt);
+    has_row = false;
+}
+
+int PreparedStatementSQLite::get_column_count()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), 0, "SQLite prepared statement is not open!");
+
+    return sqlite3_column_count(stmt);
+}
+
+String PreparedStatementSQLite::get_column_name(int column)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), String(), "SQLite prepared statement is not open!");
+    ERR_FAIL_INDEX_V(column, sqlite3_column_count(stmt), String());
+
+    return String::utf8(sqlite3_column_name(stmt, column));
+}
+
+bool PreparedStatementSQLite::is_column_null(int column)
+{
+    ERR_FAIL_COND_V_MSG(!has_row, true, "SQLite prepared statement has no row, call step() first.");
+    ERR_FAIL_INDEX_V(column, sqlite3_column_count(stmt), true);
+
+    return sqlite3_column_type(stmt, column) == SQLITE_NULL;
+}
+
+Variant PreparedStatementSQLite::get_column(int column)
+{
+    ERR_FAIL_COND_V_MSG(!has_row, Variant(), "SQLite prepared statement has no row, call step() first.");
+    ERR_FAIL_INDEX_V(column, sqlite3_column_count(stmt), Variant());
+
+    return column_value(stmt, column, is_variant_column(stmt, column));
+}
+
+int64_t PreparedStatementSQLite::get_column_int(int column)
+{
+    ERR_FAIL_COND_V_MSG(!has_row, 0, "SQLite prepared statement has no row, call step() first.");
+    ERR_FAIL_INDEX_V(column, sqlite3_column_count(stmt), 0);
+
+    return sqlite3_column_int64(stmt, column);
+}
+
+double PreparedStatementSQLite::get_column_float(int column)
+{
+    ERR_FAIL_COND_V_MSG(!has_row, 0.0, "SQLite prepared statement has no row, call step() first.");
+    ERR_FAIL_INDEX_V(column, sqlite3_column_count(stmt), 0.0);
+
+    return sqlite3_column_double(stmt, column);
+}
+
+String PreparedStatementSQLite::get_column_string(int column)
+{
+    ERR_FAIL_COND_V_MSG(!has_row, String(), "SQLite prepared statement has no row, call step() first.");
+    ERR_FAIL_INDEX_V(column, sqlite3_column_count(stmt), String());
+
+    const char *text = (const char *)sqlite3_column_text(stmt, column);
+    return String::utf8(text, sqlite3_column_bytes(stmt, column));
+}
+
+Array PreparedStatementSQLite::get_row()
+{
+    Array row;
+    ERR_FAIL_COND_V_MSG(!has_row, row, "SQLite prepared statement has no row, call step() first.");
+
+    int col_count = sqlite3_column_count(stmt);
+    row.resize(col_count);
+    for(int i = 0; i < col_count; i++)
+    {
+        row[i] = column_value(stmt, i, is_variant_column(stmt, i));
+    }
+    return row;
+}
+
+BlobStreamSQLite::~BlobStreamSQLite()
+{
+    close_blob();
+}
+
+void BlobStreamSQLite::close_blob()
+{
+    if(blob == nullptr)
+        return;
+
+    sqlite3_blob_close(blob);
+    blob = nullptr;
+    database->unregister_blob_stream(this);
+}
+
+void BlobStreamSQLite::close()
+{
+    close_blob();
+    database = Ref<DatabaseSQLite>();
+}
+
+int BlobStreamSQLite::get_length()
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), 0, "SQLite blob is not open!");
+
+    return sqlite3_blob_bytes(blob);
+}
+
+PackedByteArray BlobStreamSQLite::read(int offset, int length)
+{
+    PackedByteArray data;
+    ERR_FAIL_COND_V_MSG(!is_open(), data, "SQLite blob is not open!");
+    ERR_FAIL_COND_V(offset < 0 || length < 0, data);
+    ERR_FAIL_COND_V_MSG(offset + length > sqlite3_blob_bytes(blob), data, "SQLite blob read is out of bounds.");
+
+    if(length == 0)
+        return data;
+
+    data.resize(length);
+    int err = sqlite3_blob_read(blob, data.ptrw(), length, offset);
+    if(err != SQLITE_OK)
+    {
+        // SQLITE_ABORT means the row was changed or deleted since the blob was opened
+        print_error(String("SQLite failed to read blob: ") + sqlite3_errstr(err));
+        return PackedByteArray();
+    }
+    return data;
+}
+
+bool BlobStreamSQLite::write(int offset, PackedByteArray data)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite blob is not open!");
+    ERR_FAIL_COND_V_MSG(!writable, false, "SQLite blob was opened read-only.");
+    ERR_FAIL_COND_V(offset < 0, false);
+    ERR_FAIL_COND_V_MSG(offset + data.size() > sqlite3_blob_bytes(blob), false, "SQLite blob write is out of bounds, blobs can't grow while they are open.");
+
+    if(data.empty())
+        return true;
+
+    int err = sqlite3_blob_write(blob, data.ptr(), data.size(), offset);
+    ERR_FAIL_COND_V_MSG(err != SQLITE_OK, false, String("SQLite failed to write blob: ") + sqlite3_errstr(err));
+    return true;
+}
+
+bool BlobStreamSQLite::reopen(int64_t row)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite blob is not open!");
+
+    // Cheaper than opening a new blob, the table and column are kept
+    int err = sqlite3_blob_reopen(blob, row);
+    if(err != SQLITE_OK)
+    {
+        // The blob can't be used anymore
+        print_error(String("SQLite failed to reopen blob: ") + sqlite3_errmsg(database->connection));
+        close();
+        return false;
+    }
+    return true;
 }
\ No newline at end of file
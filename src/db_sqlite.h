@@ -2,34 +2,190 @@
 #define GODOT_DATABASE_SQLITE_H
 
 #include "database.h"
+#include "blob_stream.h"
 #include "cursor.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/hash_map.h"
+#include "core/list.h"
+#include "core/set.h"
+#include "sqlite_bindings.h"
+#include "sqlite_query_stats.h"
+#include "sqlite_statement_cache.h"
+#include "spatial_index_sqlite.h"
 #include "../thirdparty/sqlite/sqlite3.h"
+#include <atomic>
 
+class BlobStreamSQLite;
 class CursorSQLite;
+class PreparedStatementSQLite;
 
 class DatabaseSQLite : public Database
 {
+    friend class BlobStreamSQLite;
     friend class CursorSQLite;
+    friend class DatabaseMonitorSQLite;
+    friend class PreparedStatementSQLite;
+    friend class SpatialIndexSQLite;
     GDCLASS(DatabaseSQLite, Database);
 
     protected:
     static void _bind_methods();
 
     String filepath;
+    bool file_database = false; // True if the writable main database is a file on disk
 
     sqlite3 *connection = nullptr;
 
     bool auto_commit = false;
-    bool in_transaction = false; // True if there was a transaction started by the SQLite wrapper
+    int busy_timeout = 5000;
+    Error last_error = OK; // Result of the last commit() or rollback(), guarded by mutex
+
+    /// Called by SQLite when a connection is locked by another one.
+    /// Sleeps with increasing delays until the busy timeout expires.
+    static int busy_handler(void *userdata, int count);
+
+    std::atomic<bool> in_transaction{false}; // True if there was a transaction started by the SQLite wrapper
+    int execute_many_chunk_size = 0;
+
+    SQLiteStatementCache statement_cache;
+
+    bool profiling = false;
+    SQLiteQueryStats query_stats; // Shared by the writer and the readers
+
+    float slow_query_threshold = 0.0;
+    int slow_query_log_size = 32;
+    String slow_query_log_path;
+    List<Dictionary> slow_queries; // Oldest first
+    Mutex slow_query_file_mutex; // Keeps the lines of the slow query log file whole
+
+    bool is_slow_query(uint64_t usec) const {return slow_query_threshold > 0.0 && usec >= slow_query_threshold * 1000.0;}
+
+    /// Records a statement that exceeded the slow query threshold,
+    /// along with its query plan
+    void log_slow_query(const String &statement, const Array &arguments, int batch_size, uint64_t usec);
+
+    /// Returns the EXPLAIN QUERY PLAN output of statement, one line per
+    /// step and indented like the sqlite3 shell, or an empty String if
+    /// it can't be explained
+    String explain_query_plan(const String &statement);
+
+    /// Read-only connection used to run read-only statements
+    /// in parallel with the writer connection
+    struct Reader
+    {
+        sqlite3 *connection = nullptr;
+        SQLiteStatementCache statement_cache;
+        bool profiling = false; // True if query_stats is attached to the connection
+    };
+
+    int journal_mode = JOURNAL_MODE_DEFAULT;
+    int synchronous = SYNCHRONOUS_DEFAULT;
+    int cache_size = 0;
+    int64_t mmap_size = 0;
+    int temp_store = TEMP_STORE_DEFAULT;
+    bool query_only = false;
+
+    /// Applies the connection settings to db, skipping the
+    /// journal mode and synchronous settings for readers.
+    /// Returns false if a setting couldn't be applied.
+    bool apply_pragmas(sqlite3 *db, bool writer);
+
+    int reader_count = 0;
+    Vector<Reader *> readers;
+    Vector<Reader *> idle_readers;
+
+    /// Opens reader_count readers on the database at path
+    /// Returns false if any of them fails to open
+    bool open_readers(const String &path, int flags);
+    void close_readers();
+
+    /// Checks out an idle reader, or returns nullptr if none are idle
+    /// or the writer connection is inside a transaction, as readers
+    /// wouldn't see its uncommitted changes.
+    Reader *acquire_reader();
+    void release_reader(Reader *reader);
+
+    /// Applies the statement cache size and profiling settings to an idle
+    /// reader. Readers have no mutex of their own, so busy ones are only
+    /// updated once released. Must be called with mutex held.
+    void update_reader(Reader *reader);
+
+    // Whether each statement is read-only, by SQL text, guarded by mutex.
+    // Lets reads go straight to a reader without preparing them on the writer.
+    HashMap<String, bool> read_only_statements;
+
+    /// Sets r_read_only and returns true if statement was classified before
+    bool find_read_only(const String &statement, bool &r_read_only);
+    void store_read_only(const String &statement, bool read_only);
+
+    PackedByteArray deserialized_data; // Read-only database loaded by deserialize(), used in place
+
+    /// Releases every statement, blob and streaming query on the connection
+    void release_statements();
+
+    // Backup running on its own thread, see backup_to()
+    Thread *backup_thread = nullptr;
+    sqlite3_backup *backup = nullptr;
+    sqlite3 *backup_destination = nullptr; // Only set if the backup opened the destination itself
+    sqlite3 *backup_source_connection = nullptr; // Read-only connection the backup reads file databases from
+    Ref<DatabaseSQLite> backup_target;
+    Ref<DatabaseSQLite> backup_source; // Keeps this database alive until the backup is done
+    int backup_pages_per_step = 0;
+    int backup_id = 0;
+    std::atomic<bool> backup_cancelled{false};
+    Error backup_error = OK;
+
+    static void backup_thread_func(void *userdata);
+
+    /// Waits for the backup thread and releases the backup
+    void finish_backup();
+    void _backup_finished(int id);
+
+    Mutex mutex;
+    // Held for the whole of one operation on the writer connection, like a
+    // statement, a batch, a commit or a rollback, so operations from worker
+    // threads can't interleave with the wrapper's transaction or savepoints.
+    // Taken before mutex, never while holding it.
+    Mutex operation_mutex;
+    Set<CursorSQLite *> streaming_cursors; // Cursors holding a live statement on this connection
+    bool transaction_lost = false; // True until a transaction lost to interrupt() can be restarted, guarded by mutex
+
+    Set<PreparedStatementSQLite *> prepared_statements;
+    Set<BlobStreamSQLite *> blob_streams;
+
+    void register_streaming_cursor(CursorSQLite *cursor);
+    void unregister_streaming_cursor(CursorSQLite *cursor);
+    void unregister_prepared_statement(PreparedStatementSQLite *statement);
+    void unregister_blob_stream(BlobStreamSQLite *blob);
 
     /// Called after every commit() and rollback() when
     /// auto-commit is disabled
     void begin_transaction();
 
+    /// Cleans up after a cursor's statement failed with error. After an
+    /// interrupt(), flags the streaming statements left on the writer, which
+    /// would keep every new statement interrupted, so their cursors release
+    /// them on their next fetch. After ERR_SKIP or ERR_TIMEOUT, emits
+    /// "transaction_lost" if SQLite rolled back the current transaction,
+    /// like interrupted writes do, and restarts it with resume_transaction().
+    void recover_interrupt(Error error);
+
+    /// Starts the transaction lost to an interrupt once no flagged
+    /// streaming statement is left, when auto-commit is disabled
+    void resume_transaction();
+
     /// Prepares and executes the statement
-    /// Returns false if an error occurred, true
-    /// otherwise.
-    bool exec_statement(const char *statement);
+    /// Returns the error that occurred, or OK
+    Error exec_statement(const char *statement);
+
+    /// Opens the savepoint that makes an execute_many() batch atomic.
+    /// In auto-commit mode it also makes the batch a single transaction.
+    Error begin_batch();
+
+    /// Releases the batch savepoint, rolling the batch back
+    /// first if success is false.
+    Error end_batch(bool success);
 
     public:
     static const int OPEN_READONLY = SQLITE_OPEN_READONLY;
@@ -40,24 +196,222 @@ class DatabaseSQLite : public Database
     static const int OPEN_NOFOLLOW = SQLITE_OPEN_NOFOLLOW;
     static const int OPEN_DEFAULT = OPEN_READWRITE | OPEN_CREATE;
 
+    static const int JOURNAL_MODE_DEFAULT = 0;
+    static const int JOURNAL_MODE_DELETE = 1;
+    static const int JOURNAL_MODE_TRUNCATE = 2;
+    static const int JOURNAL_MODE_PERSIST = 3;
+    static const int JOURNAL_MODE_MEMORY = 4;
+    static const int JOURNAL_MODE_WAL = 5;
+    static const int JOURNAL_MODE_OFF = 6;
+
+    static const int SYNCHRONOUS_DEFAULT = 0;
+    static const int SYNCHRONOUS_OFF = 1;
+    static const int SYNCHRONOUS_NORMAL = 2;
+    static const int SYNCHRONOUS_FULL = 3;
+    static const int SYNCHRONOUS_EXTRA = 4;
+
+    static const int TEMP_STORE_DEFAULT = 0;
+    static const int TEMP_STORE_FILE = 1;
+    static const int TEMP_STORE_MEMORY = 2;
+
+    /// SQLite's default settings
+    static const int PROFILE_DEFAULT = 0;
+    /// Rollback journal with full syncs, a committed save survives a power
+    /// loss and the database is a single file when it is closed
+    static const int PROFILE_SAVE_GAME = 1;
+    /// WAL journal with synchronous=NORMAL, a power loss can lose the last
+    /// commits but never corrupts the database
+    static const int PROFILE_TELEMETRY = 2;
+    /// Large page cache and memory-mapped reads for databases that are never
+    /// written, with the connection restricted to queries
+    static const int PROFILE_READ_ONLY_ASSET = 3;
+
     virtual bool is_open();
 
     virtual void close();
 
-    virtual void commit();
+    virtual Error commit();
 
-    virtual void rollback();
+    virtual Error rollback();
+
+    /// Stops the statements running on the writer and reader connections.
+    /// Cursors report interrupted statements with ERR_SKIP. Streaming queries
+    /// on the writer that are waiting for their next fetch are released by
+    /// their next fetch, which returns no rows and reports ERR_SKIP as well.
+    /// An interrupted write rolls back the whole transaction: "transaction_lost"
+    /// is emitted, and a new one is started when auto-commit is disabled.
+    virtual void interrupt();
 
     /// Enable or disable auto-commit transactions
     /// False by default
     void set_auto_commit(bool value);
     bool get_auto_commit() const {return auto_commit;}
 
+    /// Set the number of rows after which execute_many() commits
+    /// a batch in auto-commit mode, to avoid holding the write lock
+    /// for the whole batch. A failing row only rolls back its own chunk.
+    /// 0 commits the whole batch at once, and is the default
+    void set_execute_many_chunk_size(int value);
+    int get_execute_many_chunk_size() const {return execute_many_chunk_size;}
+
+    /// Set the maximum number of idle prepared statements kept
+    /// for reuse. 0 disables the statement cache.
+    /// 32 by default
+    void set_statement_cache_size(int value);
+    int get_statement_cache_size() const {return statement_cache.get_capacity();}
+
+    /// Connection settings applied by open(), before the first transaction
+    /// is started. They only take effect on the next open().
+    ///
+    /// The journal mode persists in the database file for WAL, the
+    /// other settings only last for the connection.
+    void set_journal_mode(int value);
+    int get_journal_mode() const {return journal_mode;}
+    void set_synchronous(int value);
+    int get_synchronous() const {return synchronous;}
+    /// Size of the page cache of each connection in KiB. 0 keeps SQLite's default
+    void set_cache_size(int value);
+    int get_cache_size() const {return cache_size;}
+    /// Maximum number of bytes of the database file that are memory-mapped.
+    /// 0 disables memory-mapped I/O, and is the default
+    void set_mmap_size(int64_t value);
+    int64_t get_mmap_size() const {return mmap_size;}
+    void set_temp_store(int value);
+    int get_temp_store() const {return temp_store;}
+    /// Reject every statement that would change the database file
+    void set_query_only(bool value) {query_only = value;}
+    bool is_query_only() const {return query_only;}
+
+    /// Sets every connection setting from one of the PROFILE_* presets
+    void apply_profile(int profile);
+
+    /// Set how long a statement waits for a database locked by another
+    /// connection, in milliseconds, before failing with ERR_BUSY.
+    /// 0 fails immediately. 5000 by default
+    void set_busy_timeout(int value);
+    int get_busy_timeout() const {return busy_timeout;}
+
+    /// Returns the result of the last commit() or rollback(), on any thread.
+    /// The transactions and savepoints the wrapper opens itself don't change it.
+    /// ERR_BUSY if the database stayed locked for longer than the busy timeout
+    Error get_last_error();
+
+    /// Set the number of read-only connections opened next to the
+    /// writer connection by open(). Read-only statements executed by
+    /// cursors in auto-commit mode, outside of a transaction, are run
+    /// on an idle reader so they don't queue on the writer connection.
+    ///
+    /// Readers are only used with auto_commit enabled. With auto-commit
+    /// disabled, the default, the writer always holds a transaction whose
+    /// uncommitted changes readers wouldn't see, so every statement runs
+    /// on the writer.
+    ///
+    /// The database is switched to WAL journal mode so readers don't
+    /// block the writer, and no readers are opened if it can't be.
+    /// Only takes effect on the next open(). 0 by default
+    void set_reader_count(int value);
+    int get_reader_count() const {return reader_count;}
+
+    /// Returns the size, hits, misses and evictions of the statement
+    /// caches of the writer and reader connections
+    Dictionary get_statement_cache_stats() const;
+    void reset_statement_cache_stats();
+
+    /// Enable or disable recording the execution time of every statement
+    /// run on the writer and reader connections, for get_query_stats().
+    /// Adds a small cost to every statement and returned row.
+    /// False by default
+    void set_profiling(bool value);
+    bool is_profiling() const {return profiling;}
+
+    /// Returns the statistics recorded while profiling, one Dictionary per
+    /// statement text with its literals replaced by "?", slowest total time first:
+    /// "statement", "calls", "total_usec", "min_usec", "max_usec",
+    /// "p99_usec" over the last 512 calls, "rows_returned", and
+    /// "rows_scanned" by full table scans.
+    Array get_query_stats();
+    void reset_query_stats();
+
+    /// Set the time in milliseconds after which a statement run by
+    /// execute(), execute_many() or execute_many_columns() is logged
+    /// as a slow query. 0 disables the slow query log, and is the default
+    void set_slow_query_threshold(float value);
+    float get_slow_query_threshold() const {return slow_query_threshold;}
+
+    /// Set the number of slow queries kept by get_slow_queries(),
+    /// the oldest ones are dropped first. 32 by default
+    void set_slow_query_log_size(int value);
+    int get_slow_query_log_size() const {return slow_query_log_size;}
+
+    /// Set a file every slow query is also appended to, as one line of JSON.
+    /// Empty by default
+    void set_slow_query_log_path(String value) {MutexLock lock(mutex); slow_query_log_path = value;}
+    String get_slow_query_log_path() {MutexLock lock(mutex); return slow_query_log_path;}
+
+    /// Returns the last slow queries, oldest first, as Dictionaries with
+    /// "statement", "arguments" (of the first row of a batch), "batch_size",
+    /// "usec", the "plan" from EXPLAIN QUERY PLAN, and the unix "time"
+    Array get_slow_queries();
+    void clear_slow_queries();
+
     bool open(String path, int flags);
 
     String get_filepath() const {return filepath;}
 
     virtual Ref<Cursor> cursor();
+
+    virtual Ref<PreparedStatement> prepare(String statement);
+
+    /// Opens the blob stored in column of the row with the given rowid.
+    /// Blobs can't be resized through a stream, so preallocate them
+    /// with allocate_blob() and fill them with write().
+    /// Returns an invalid reference if the cell can't be opened.
+    Ref<BlobStream> open_blob(String table, String column, int64_t row, bool writable = false, String schema = "main");
+
+    /// Replaces the cell at column of the row with the given rowid by a
+    /// zero-filled blob of size bytes, without building it in memory.
+    Error allocate_blob(String table, String column, int64_t row, int64_t size, String schema = "main");
+
+    /// Copies the database to target, a file path or another open DatabaseSQLite,
+    /// without blocking the connection for the whole copy.
+    ///
+    /// The backup runs on its own thread and copies pages_per_step pages at a time,
+    /// so other statements can run on the connection between steps. Changes
+    /// committed during the backup are included in the copy. File databases
+    /// are read through their own read-only connection, so uncommitted changes
+    /// are left out. In-memory databases are read from the connection itself,
+    /// and their uncommitted changes are included. "backup_progress" is
+    /// emitted after every step, and "backup_completed" once the backup is done.
+    /// Only one backup can run at a time. Returns false if it can't be started.
+    bool backup_to(Variant target, int pages_per_step = 256);
+    bool is_backup_running() const {return backup_thread != nullptr;}
+
+    /// Stops the running backup. "backup_completed" is emitted with ERR_SKIP
+    /// on the next idle frame, not from within this call.
+    /// The destination is left as it was before the backup started.
+    void cancel_backup();
+
+    /// Returns the whole database as bytes, in the SQLite file format.
+    /// In-memory databases are copied once, straight from their memory.
+    /// Uncommitted changes of the connection are included.
+    PackedByteArray serialize();
+
+    /// Replaces the database with the one in data, as returned by serialize().
+    /// The database is then held in memory, and its file isn't modified.
+    /// A closed database is opened in memory first. Uncommitted changes are rolled back.
+    ///
+    /// A read-only database is used in place without being copied, and
+    /// keeps a reference to data until it is closed.
+    bool deserialize(PackedByteArray data, bool read_only = false);
+
+    /// Returns the 2D or 3D spatial index stored in the R*Tree table
+    /// with the given name, creating the table if it doesn't exist.
+    Ref<SpatialIndexSQLite> spatial_index(String table, int dimensions = 3);
+
+    /// Returns the rowid of the last row inserted on the writer connection
+    int64_t get_last_insert_rowid();
+
+    ~DatabaseSQLite();
 };
 
 class CursorSQLite : public Cursor
@@ -66,33 +420,209 @@ class CursorSQLite : public Cursor
     GDCLASS(CursorSQLite, Cursor);
 
     protected:
-    static void _bind_methods() {};
+    static void _bind_methods();
 
-    Dictionary parse_row(sqlite3_stmt *stmt);
+    /// Reads the current row of stmt in the cursor's row format
+    Variant parse_row(sqlite3_stmt *stmt);
+
+    /// Caches the column names of a freshly prepared statement
+    void read_description(sqlite3_stmt *stmt);
+
+    /// Collects up to size rows into columns, stepping the live
+    /// statement when streaming. A negative size collects every row.
+    Dictionary collect_columns(int size);
+
+    /// Runs execute() without the slow query log
+    bool execute_statement(String statement, Array arguments);
 
     /// Binds the parameters for a statement
     /// Returns false if an error occurs while binding
     bool bind_parameters(sqlite3_stmt *stmt, Array arguments);
 
+    /// Steps one row of a batch to completion and resets the statement
+    /// Returns false if an error occurs
+    bool step_batch_row(sqlite3_stmt *stmt);
+
+    /// Binds the parameters of one row of a batch
+    /// Returns false if an error occurs while binding
+    typedef bool (*BindRowFunc)(CursorSQLite *cursor, sqlite3_stmt *stmt, int row, void *userdata);
+
+    /// Executes statement once for each of row_count rows inside
+    /// a single batch savepoint
+    bool execute_batch(String statement, int row_count, BindRowFunc bind_row, void *userdata);
+
+    SQLiteBindings bindings; // Buffers bound to the statement being executed
+    Error last_error = OK;
+    int timeout = 0;
+    DatabaseSQLite::Reader *reader = nullptr; // Reader connection the statement belongs to, if any
+
+    /// Returns stmt to the statement cache and releases its bound buffers
+    void release_to_cache(const String &sql, sqlite3_stmt *stmt);
+
     Array last_result;
     int result_pos = 0;
 
+    PackedStringArray description;
+    Vector<Variant> column_keys; // Dictionary keys built once per statement
+    Vector<bool> variant_columns; // Columns declared as VARIANT
+
+    bool streaming = false;
+    sqlite3_stmt *stmt = nullptr; // Live statement of a streaming query
+    String stmt_sql; // Statement cache key of stmt
+    bool has_row = false; // True if stmt is positioned on a row that hasn't been fetched yet
+    bool fetch_finished = false; // True once fetch_timed() has emitted "finished" for the current query
+
+    /// Returns the live statement of a streaming query to
+    /// the statement cache, if any.
+    void release_statement();
+
+    /// Set by DatabaseSQLite when interrupt() stopped the live statement
+    /// while it was waiting for a fetch, guarded by the database's mutex
+    bool interrupted = false;
+
+    /// Releases the live statement if it was interrupted, reporting ERR_SKIP.
+    /// Only called by the thread using the cursor, before it steps.
+    void check_interrupted();
+
+    /// Steps the live statement to the next row.
+    /// Releases the statement once the result set is exhausted
+    /// or an error occurs.
+    void advance_statement();
+
     Ref<DatabaseSQLite> database;
 
     virtual bool is_open() {return database.is_valid() && database->is_open();}
-    virtual void close() {database = Ref<DatabaseSQLite>();}
+    virtual void close();
 
     virtual bool callproc(String procname, Array arguments);
     virtual bool execute(String statement, Array arguments);
     virtual bool execute_many(String statement, Array arguments);
+    virtual bool execute_many_columns(String statement, Array columns);
 
     virtual int get_row_count();
 
     virtual void scroll(int amount, bool absolute);
 
-    virtual Dictionary fetch_one();
+    virtual PackedStringArray get_description() {return description;}
+
+    virtual Variant fetch_one();
     virtual Array fetch_many(int size);
     virtual Array fetch_all();
+
+    virtual Dictionary fetch_columns_many(int size);
+    virtual Dictionary fetch_columns();
+
+    public:
+    /// Enable or disable streaming results.
+    /// When enabled, execute() keeps the statement alive and rows
+    /// are stepped on demand by the fetch methods instead of being
+    /// collected up front. Streaming cursors can only scroll forward.
+    /// Changing the mode discards the rows left by the last execute().
+    /// False by default
+    void set_streaming(bool value);
+    bool is_streaming() const {return streaming;}
+
+    /// Set the time in milliseconds a statement run by execute(),
+    /// execute_many() or execute_many_columns() may take before it is
+    /// interrupted. Streaming queries are only timed up to their first row.
+    /// Needs SQLite's progress callback, which is only built with the
+    /// sqlite_progress_callback=yes build option.
+    /// 0 disables the timeout, and is the default
+    void set_timeout(int value);
+    int get_timeout() const {return timeout;}
+
+    /// Fetches rows for up to budget milliseconds, stepping the live
+    /// statement of a streaming query, and returns them.
+    /// At least one row is fetched if any are left, so calling it once
+    /// per frame always makes progress. Emits "rows_available" with the
+    /// rows if there were any, and "finished" once the result is exhausted.
+    Array fetch_timed(float budget);
+
+    /// Returns the result of the last execute() or execute_many(),
+    /// including the rows stepped by the fetch methods of a streaming query.
+    /// ERR_BUSY if the database stayed locked for longer than the busy timeout,
+    /// ERR_INVALID_PARAMETER if the arguments couldn't be bound,
+    /// ERR_TIMEOUT if the statement ran past the timeout,
+    /// ERR_SKIP if it was stopped by DatabaseSQLite.interrupt(),
+    /// ERR_QUERY_FAILED for any other error.
+    Error get_last_error() const {return last_error;}
+
+    ~CursorSQLite();
+};
+
+class PreparedStatementSQLite : public PreparedStatement
+{
+    friend class DatabaseSQLite;
+    GDCLASS(PreparedStatementSQLite, PreparedStatement);
+
+    protected:
+    static void _bind_methods() {};
+
+    Ref<DatabaseSQLite> database;
+    sqlite3_stmt *stmt = nullptr;
+    bool has_row = false; // True if the last step() returned a row
+    SQLiteBindings bindings;
+
+    /// Finalizes the statement without releasing the database
+    void finalize_statement();
+
+    public:
+    virtual bool is_open() {return stmt != nullptr && database.is_valid() && database->is_open();}
+    virtual void close();
+
+    virtual String get_sql();
+
+    virtual int get_parameter_count();
+    virtual int get_parameter_index(String name);
+
+    virtual bool bind(int index, Variant value);
+    virtual bool bind_named(String name, Variant value);
+    virtual bool bind_all(Array arguments);
+    virtual void clear_bindings();
+
+    virtual int step();
+    virtual void reset();
+
+    virtual int get_column_count();
+    virtual String get_column_name(int column);
+    virtual bool is_column_null(int column);
+    virtual Variant get_column(int column);
+    virtual int64_t get_column_int(int column);
+    virtual double get_column_float(int column);
+    virtual String get_column_string(int column);
+    virtual Array get_row();
+
+    ~PreparedStatementSQLite();
+};
+
+class BlobStreamSQLite : public BlobStream
+{
+    friend class DatabaseSQLite;
+    GDCLASS(BlobStreamSQLite, BlobStream);
+
+    protected:
+    static void _bind_methods() {};
+
+    Ref<DatabaseSQLite> database;
+    sqlite3_blob *blob = nullptr;
+    bool writable = false;
+
+    /// Closes the blob without releasing the database
+    void close_blob();
+
+    public:
+    virtual bool is_open() {return blob != nullptr && database.is_valid() && database->is_open();}
+    virtual void close();
+
+    virtual bool is_writable() {return writable;}
+    virtual int get_length();
+
+    virtual PackedByteArray read(int offset, int length);
+    virtual bool write(int offset, PackedByteArray data);
+
+    virtual bool reopen(int64_t row);
+
+    ~BlobStreamSQLite();
 };
 
 #endif
\ No newline at end of file
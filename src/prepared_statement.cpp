@@ -0,0 +1,29 @@
+#include "prepared_statement.h"
+
+void PreparedStatement::_bind_methods()
+{
+    BIND_ENUM_CONSTANT(STEP_ROW);
+    BIND_ENUM_CONSTANT(STEP_DONE);
+    BIND_ENUM_CONSTANT(STEP_ERROR);
+    BIND_ENUM_CONSTANT(STEP_BUSY);
+
+    ClassDB::bind_method(D_METHOD("is_open"), &PreparedStatement::is_open);
+    ClassDB::bind_method(D_METHOD("close"), &PreparedStatement::close);
+    ClassDB::bind_method(D_METHOD("get_sql"), &PreparedStatement::get_sql);
+    ClassDB::bind_method(D_METHOD("get_parameter_count"), &PreparedStatement::get_parameter_count);
+    ClassDB::bind_method(D_METHOD("get_parameter_index", "name"), &PreparedStatement::get_parameter_index);
+    ClassDB::bind_method(D_METHOD("bind", "index", "value"), &PreparedStatement::bind);
+    ClassDB::bind_method(D_METHOD("bind_named", "name", "value"), &PreparedStatement::bind_named);
+    ClassDB::bind_method(D_METHOD("bind_all", "arguments"), &PreparedStatement::bind_all);
+    ClassDB::bind_method(D_METHOD("clear_bindings"), &PreparedStatement::clear_bindings);
+    ClassDB::bind_method(D_METHOD("step"), &PreparedStatement::step);
+    ClassDB::bind_method(D_METHOD("reset"), &PreparedStatement::reset);
+    ClassDB::bind_method(D_METHOD("get_column_count"), &PreparedStatement::get_column_count);
+    ClassDB::bind_method(D_METHOD("get_column_name", "column"), &PreparedStatement::get_column_name);
+    ClassDB::bind_method(D_METHOD("is_column_null", "column"), &PreparedStatement::is_column_null);
+    ClassDB::bind_method(D_METHOD("get_column", "column"), &PreparedStatement::get_column);
+    ClassDB::bind_method(D_METHOD("get_column_int", "column"), &PreparedStatement::get_column_int);
+    ClassDB::bind_method(D_METHOD("get_column_float", "column"), &PreparedStatement::get_column_float);
+    ClassDB::bind_method(D_METHOD("get_column_string", "column"), &PreparedStatement::get_column_string);
+    ClassDB::bind_method(D_METHOD("get_row"), &PreparedStatement::get_row);
+}
@@ -0,0 +1,83 @@
+#ifndef GODOT_PREPARED_STATEMENT_H
+#define GODOT_PREPARED_STATEMENT_H
+
+#include "core/reference.h"
+#include "core/ustring.h"
+
+/// A database statement that is compiled once and can be executed
+/// many times with different parameters.
+///
+/// Parameters and columns are indexed from 0.
+class PreparedStatement : public Reference {
+    GDCLASS(PreparedStatement, Reference);
+
+    protected:
+    static void _bind_methods();
+
+    public:
+    /// A result row is available through the column accessors
+    static const int STEP_ROW = 0;
+    /// The statement has finished executing
+    static const int STEP_DONE = 1;
+    /// An error occurred while executing the statement
+    static const int STEP_ERROR = 2;
+    /// The database stayed locked by another connection for too long
+    static const int STEP_BUSY = 3;
+
+    /// Returns true if the statement is still valid and its database is open
+    virtual bool is_open() = 0;
+
+    /// Release the statement, rendering it invalid for further use.
+    virtual void close() = 0;
+
+    /// Returns the statement text the statement was compiled from.
+    virtual String get_sql() = 0;
+
+    /// Returns the number of parameters the statement expects.
+    virtual int get_parameter_count() = 0;
+
+    /// Returns the index of the named parameter, or -1 if there is none.
+    virtual int get_parameter_index(String name) = 0;
+
+    /// Binds a value to the parameter at the given index.
+    /// Bindings are kept across reset() until they are replaced or cleared.
+    virtual bool bind(int index, Variant value) = 0;
+
+    /// Binds a value to the named parameter.
+    virtual bool bind_named(String name, Variant value) = 0;
+
+    /// Binds an Array of values to the parameters in order.
+    virtual bool bind_all(Array arguments) = 0;
+
+    /// Sets every parameter back to null.
+    virtual void clear_bindings() = 0;
+
+    /// Executes the statement up to the next result row.
+    /// Returns STEP_ROW, STEP_DONE, STEP_BUSY or STEP_ERROR.
+    virtual int step() = 0;
+
+    /// Resets the statement so it can be stepped again from the start.
+    virtual void reset() = 0;
+
+    /// Returns the number of columns in the statement's results.
+    virtual int get_column_count() = 0;
+
+    virtual String get_column_name(int column) = 0;
+
+    /// Returns true if the column of the current row is null.
+    virtual bool is_column_null(int column) = 0;
+
+    /// Returns the column of the current row as a Variant of its stored type.
+    virtual Variant get_column(int column) = 0;
+
+    /// Typed accessors for the column of the current row.
+    /// The value is converted if the stored type differs.
+    virtual int64_t get_column_int(int column) = 0;
+    virtual double get_column_float(int column) = 0;
+    virtual String get_column_string(int column) = 0;
+
+    /// Returns every column of the current row as an Array.
+    virtual Array get_row() = 0;
+};
+
+#endif
@@ -0,0 +1,291 @@
+#include "spatial_index_sqlite.h"
+#include "db_sqlite.h"
+
+static const char *axes[] = {"x", "y", "z"};
+
+void SpatialIndexSQLite::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("is_open"), &SpatialIndexSQLite::is_open);
+    ClassDB::bind_method(D_METHOD("get_table"), &SpatialIndexSQLite::get_table);
+    ClassDB::bind_method(D_METHOD("get_dimensions"), &SpatialIndexSQLite::get_dimensions);
+    ClassDB::bind_method(D_METHOD("insert_points", "ids", "points"), &SpatialIndexSQLite::insert_points);
+    ClassDB::bind_method(D_METHOD("insert_boxes", "ids", "boxes"), &SpatialIndexSQLite::insert_boxes);
+    ClassDB::bind_method(D_METHOD("remove", "ids"), &SpatialIndexSQLite::remove);
+    ClassDB::bind_method(D_METHOD("query_box", "box"), &SpatialIndexSQLite::query_box);
+    ClassDB::bind_method(D_METHOD("query_radius", "center", "radius"), &SpatialIndexSQLite::query_radius);
+}
+
+bool SpatialIndexSQLite::is_open()
+{
+    return database.is_valid() && database->is_open();
+}
+
+void SpatialIndexSQLite::setup(const String &p_table, int p_dimensions)
+{
+    table = p_table;
+    dimensions = p_dimensions;
+
+    String quoted = "\"" + table.replace("\"", "\"\"") + "\"";
+
+    String columns = "id";
+    String values = "?";
+    String box_where;
+    String distance;
+    for(int i = 0; i < dimensions; i++)
+    {
+        String axis = axes[i];
+        columns += ", min_" + axis + ", max_" + axis;
+        values += ", ?, ?";
+
+        // Parameters 1 to 2 * dimensions are the bounds of the query box
+        if(i > 0)
+        {
+            box_where += " AND ";
+            distance += " + ";
+        }
+        box_where += "min_" + axis + " <= ?" + itos(i * 2 + 2) + " AND max_" + axis + " >= ?" + itos(i * 2 + 1);
+
+        // The distance from the center to the closest point of the entry on this axis
+        String center = "?" + itos(dimensions * 2 + i + 1);
+        String delta = "max(min_" + axis + " - " + center + ", 0.0, " + center + " - max_" + axis + ")";
+        distance += delta + " * " + delta;
+    }
+
+    insert_sql = "INSERT OR REPLACE INTO " + quoted + " (" + columns + ") VALUES (" + values + ")";
+    remove_sql = "DELETE FROM " + quoted + " WHERE id = ?";
+    box_sql = "SELECT id FROM " + quoted + " WHERE " + box_where;
+    // The box query uses the R*Tree, the distance check only runs on its results
+    radius_sql = box_sql + " AND " + distance + " <= ?" + itos(dimensions * 3 + 1);
+}
+
+bool SpatialIndexSQLite::insert(const PackedInt64Array &ids, const Vector<double> &bounds)
+{
+    MutexLock operation_lock(database->operation_mutex);
+    SQLiteStatementCache &cache = database->statement_cache;
+    sqlite3_stmt *stmt = cache.acquire(insert_sql);
+    if(stmt == nullptr)
+        return false;
+
+    if(database->begin_batch() != OK)
+    {
+        cache.release(insert_sql, stmt);
+        return false;
+    }
+
+    int columns = dimensions * 2;
+    const double *bound = bounds.ptr();
+    for(int i = 0; i < ids.size(); i++)
+    {
+        sqlite3_bind_int64(stmt, 1, ids[i]);
+        for(int j = 0; j < columns; j++)
+        {
+            sqlite3_bind_double(stmt, j + 2, *bound++);
+        }
+
+        int err = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if(err != SQLITE_DONE)
+        {
+            print_error(String("SQLite failed to insert into spatial index: ") + sqlite3_errmsg(database->connection));
+            database->end_batch(false);
+            cache.release(insert_sql, stmt);
+            return false;
+        }
+    }
+
+    cache.release(insert_sql, stmt);
+    return database->end_batch(true) == OK;
+}
+
+PackedInt64Array SpatialIndexSQLite::query(const String &sql, const double *params, int param_count)
+{
+    PackedInt64Array ids;
+
+    MutexLock operation_lock(database->operation_mutex);
+    SQLiteStatementCache &cache = database->statement_cache;
+    sqlite3_stmt *stmt = cache.acquire(sql);
+    if(stmt == nullptr)
+        return ids;
+
+    for(int i = 0; i < param_count; i++)
+    {
+        sqlite3_bind_double(stmt, i + 1, params[i]);
+    }
+
+    int err;
+    while((err = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        ids.push_back(sqlite3_column_int64(stmt, 0));
+    }
+
+    if(err != SQLITE_DONE)
+        print_error(String("SQLite failed to query spatial index: ") + sqlite3_errmsg(database->connection));
+
+    cache.release(sql, stmt);
+    return ids;
+}
+
+bool SpatialIndexSQLite::insert_points(PackedInt64Array ids, Variant points)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite spatial index is not open!");
+
+    Vector<double> bounds;
+    if(dimensions == 2)
+    {
+        ERR_FAIL_COND_V_MSG(points.get_type() != Variant::PACKED_VECTOR2_ARRAY, false, "2D spatial indexes expect a PackedVector2Array of points.");
+        PackedVector2Array array = points;
+        ERR_FAIL_COND_V_MSG(array.size() != ids.size(), false, "SQLite spatial index expects one id per point.");
+
+        bounds.resize(array.size() * 4);
+        double *bound = bounds.ptrw();
+        for(int i = 0; i < array.size(); i++)
+        {
+            const Vector2 &point = array[i];
+            *bound++ = point.x; *bound++ = point.x;
+            *bound++ = point.y; *bound++ = point.y;
+        }
+    }
+    else
+    {
+        ERR_FAIL_COND_V_MSG(points.get_type() != Variant::PACKED_VECTOR3_ARRAY, false, "3D spatial indexes expect a PackedVector3Array of points.");
+        PackedVector3Array array = points;
+        ERR_FAIL_COND_V_MSG(array.size() != ids.size(), false, "SQLite spatial index expects one id per point.");
+
+        bounds.resize(array.size() * 6);
+        double *bound = bounds.ptrw();
+        for(int i = 0; i < array.size(); i++)
+        {
+            const Vector3 &point = array[i];
+            *bound++ = point.x; *bound++ = point.x;
+            *bound++ = point.y; *bound++ = point.y;
+            *bound++ = point.z; *bound++ = point.z;
+        }
+    }
+
+    return insert(ids, bounds);
+}
+
+bool SpatialIndexSQLite::insert_boxes(PackedInt64Array ids, Array boxes)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite spatial index is not open!");
+    ERR_FAIL_COND_V_MSG(boxes.size() != ids.size(), false, "SQLite spatial index expects one id per box.");
+
+    Vector<double> bounds;
+    bounds.resize(boxes.size() * dimensions * 2);
+    double *bound = bounds.ptrw();
+    for(int i = 0; i < boxes.size(); i++)
+    {
+        if(dimensions == 2)
+        {
+            ERR_FAIL_COND_V_MSG(boxes[i].get_type() != Variant::RECT2, false, "2D spatial indexes expect an Array of Rect2.");
+            Rect2 rect = boxes[i];
+            Vector2 end = rect.position + rect.size;
+            *bound++ = rect.position.x; *bound++ = end.x;
+            *bound++ = rect.position.y; *bound++ = end.y;
+        }
+        else
+        {
+            ERR_FAIL_COND_V_MSG(boxes[i].get_type() != Variant::AABB, false, "3D spatial indexes expect an Array of AABB.");
+            AABB aabb = boxes[i];
+            Vector3 end = aabb.position + aabb.size;
+            *bound++ = aabb.position.x; *bound++ = end.x;
+            *bound++ = aabb.position.y; *bound++ = end.y;
+            *bound++ = aabb.position.z; *bound++ = end.z;
+        }
+    }
+
+    return insert(ids, bounds);
+}
+
+bool SpatialIndexSQLite::remove(PackedInt64Array ids)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), false, "SQLite spatial index is not open!");
+
+    MutexLock operation_lock(database->operation_mutex);
+    SQLiteStatementCache &cache = database->statement_cache;
+    sqlite3_stmt *stmt = cache.acquire(remove_sql);
+    if(stmt == nullptr)
+        return false;
+
+    if(database->begin_batch() != OK)
+    {
+        cache.release(remove_sql, stmt);
+        return false;
+    }
+
+    for(int i = 0; i < ids.size(); i++)
+    {
+        sqlite3_bind_int64(stmt, 1, ids[i]);
+        int err = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if(err != SQLITE_DONE)
+        {
+            print_error(String("SQLite failed to remove from spatial index: ") + sqlite3_errmsg(database->connection));
+            database->end_batch(false);
+            cache.release(remove_sql, stmt);
+            return false;
+        }
+    }
+
+    cache.release(remove_sql, stmt);
+    return database->end_batch(true) == OK;
+}
+
+PackedInt64Array SpatialIndexSQLite::query_box(Variant box)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), PackedInt64Array(), "SQLite spatial index is not open!");
+
+    double params[6];
+    if(dimensions == 2)
+    {
+        ERR_FAIL_COND_V_MSG(box.get_type() != Variant::RECT2, PackedInt64Array(), "2D spatial indexes expect a Rect2 box.");
+        Rect2 rect = box;
+        params[0] = rect.position.x; params[1] = rect.position.x + rect.size.x;
+        params[2] = rect.position.y; params[3] = rect.position.y + rect.size.y;
+    }
+    else
+    {
+        ERR_FAIL_COND_V_MSG(box.get_type() != Variant::AABB, PackedInt64Array(), "3D spatial indexes expect an AABB box.");
+        AABB aabb = box;
+        params[0] = aabb.position.x; params[1] = aabb.position.x + aabb.size.x;
+        params[2] = aabb.position.y; params[3] = aabb.position.y + aabb.size.y;
+        params[4] = aabb.position.z; params[5] = aabb.position.z + aabb.size.z;
+    }
+
+    return query(box_sql, params, dimensions * 2);
+}
+
+PackedInt64Array SpatialIndexSQLite::query_radius(Variant center, double radius)
+{
+    ERR_FAIL_COND_V_MSG(!is_open(), PackedInt64Array(), "SQLite spatial index is not open!");
+    ERR_FAIL_COND_V(radius < 0, PackedInt64Array());
+
+    // The bounding box of the sphere, then its center and squared radius
+    double params[10];
+    double position[3];
+    if(dimensions == 2)
+    {
+        ERR_FAIL_COND_V_MSG(center.get_type() != Variant::VECTOR2, PackedInt64Array(), "2D spatial indexes expect a Vector2 center.");
+        Vector2 point = center;
+        position[0] = point.x;
+        position[1] = point.y;
+    }
+    else
+    {
+        ERR_FAIL_COND_V_MSG(center.get_type() != Variant::VECTOR3, PackedInt64Array(), "3D spatial indexes expect a Vector3 center.");
+        Vector3 point = center;
+        position[0] = point.x;
+        position[1] = point.y;
+        position[2] = point.z;
+    }
+
+    for(int i = 0; i < dimensions; i++)
+    {
+        params[i * 2] = position[i] - radius;
+        params[i * 2 + 1] = position[i] + radius;
+        params[dimensions * 2 + i] = position[i];
+    }
+    params[dimensions * 3] = radius * radius;
+
+    return query(radius_sql, params, dimensions * 3 + 1);
+}
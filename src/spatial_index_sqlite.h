@@ -0,0 +1,67 @@
+#ifndef GODOT_SPATIAL_INDEX_SQLITE_H
+#define GODOT_SPATIAL_INDEX_SQLITE_H
+
+#include "core/reference.h"
+#include "core/ustring.h"
+#include "../thirdparty/sqlite/sqlite3.h"
+
+class DatabaseSQLite;
+
+/// 2D or 3D spatial index stored in an SQLite R*Tree table,
+/// returned by DatabaseSQLite.spatial_index().
+///
+/// Entries are boxes identified by a 64-bit id, points are stored as empty boxes.
+/// Coordinates are stored as 32-bit floats, rounded outwards, so
+/// queries can return entries that are slightly out of range.
+/// Queries return ids straight into a PackedInt64Array.
+class SpatialIndexSQLite : public Reference {
+    GDCLASS(SpatialIndexSQLite, Reference);
+    friend class DatabaseSQLite;
+
+    protected:
+    static void _bind_methods();
+
+    Ref<DatabaseSQLite> database;
+    String table;
+    int dimensions = 3;
+
+    String insert_sql;
+    String remove_sql;
+    String box_sql;
+    String radius_sql;
+
+    /// Builds the statements of the index for table
+    void setup(const String &p_table, int p_dimensions);
+
+    /// Inserts or replaces one entry per id. bounds holds the minimum and
+    /// maximum of every axis of each entry, in the column order of the table.
+    bool insert(const PackedInt64Array &ids, const Vector<double> &bounds);
+
+    /// Runs a query statement with the given parameters and returns the ids it selects
+    PackedInt64Array query(const String &sql, const double *params, int param_count);
+
+    public:
+    bool is_open();
+
+    String get_table() const {return table;}
+    int get_dimensions() const {return dimensions;}
+
+    /// Inserts or moves points, a PackedVector2Array or PackedVector3Array
+    /// matching the dimensions of the index, with one id per point.
+    bool insert_points(PackedInt64Array ids, Variant points);
+
+    /// Inserts or moves boxes, an Array of Rect2 or AABB
+    /// matching the dimensions of the index, with one id per box.
+    bool insert_boxes(PackedInt64Array ids, Array boxes);
+
+    /// Removes the entries with the given ids
+    bool remove(PackedInt64Array ids);
+
+    /// Returns the ids of the entries intersecting box, a Rect2 or an AABB
+    PackedInt64Array query_box(Variant box);
+
+    /// Returns the ids of the entries within radius of center, a Vector2 or a Vector3
+    PackedInt64Array query_radius(Variant center, double radius);
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "sqlite_bindings.h"
+#include "core/io/marshalls.h"
+
+const uint8_t SQLiteBindings::variant_tag[4] = {'G', 'D', 'V', 0};
+
+SQLiteBindings::Slot &SQLiteBindings::get_slot(int index)
+{
+    if(slots.size() < index)
+        slots.resize(index);
+
+    return slots.write[index - 1];
+}
+
+int SQLiteBindings::bind(sqlite3_stmt *stmt, int index, const Variant &value)
+{
+    switch (value.get_type()) {
+    case Variant::Type::NIL:
+        return sqlite3_bind_null(stmt, index);
+    case Variant::Type::BOOL:
+    case Variant::Type::INT:
+        return sqlite3_bind_int64(stmt, index, (int64_t)value);
+    case Variant::Type::FLOAT:
+        return sqlite3_bind_double(stmt, index, (double)value);
+    case Variant::Type::STRING:
+    case Variant::Type::STRING_NAME:
+    case Variant::Type::NODE_PATH:
+        return bind_text(stmt, index, String(value));
+    case Variant::Type::PACKED_BYTE_ARRAY:
+        return bind_blob(stmt, index, value);
+    case Variant::Type::OBJECT:
+    case Variant::Type::CALLABLE:
+    case Variant::Type::SIGNAL:
+        print_error("SQLite was passed unhandled Variant with TYPE_* enum " + itos(value.get_type()) + ". Please serialize your object into a String or a PackedByteArray.\n");
+        return SQLITE_MISMATCH;
+    default:
+        return bind_encoded(stmt, index, value);
+    }
+}
+
+int SQLiteBindings::bind_text(sqlite3_stmt *stmt, int index, const String &value)
+{
+    // The statement may still point to the slot's previous buffer,
+    // so it is only replaced once SQLite has taken the new one
+    CharString text = value.utf8();
+    int err = sqlite3_bind_text(stmt, index, text.get_data(), text.length(), SQLITE_STATIC);
+    if(err == SQLITE_OK)
+        get_slot(index).text = text;
+    return err;
+}
+
+int SQLiteBindings::bind_blob(sqlite3_stmt *stmt, int index, const PackedByteArray &value)
+{
+    // An empty blob has no data pointer, which SQLite would bind as NULL
+    if(value.empty())
+        return sqlite3_bind_zeroblob(stmt, index, 0);
+
+    // Holding a reference keeps the data alive even if the caller writes to
+    // its copy, since that write makes the caller's array copy the data instead
+    int err = sqlite3_bind_blob(stmt, index, value.ptr(), value.size(), SQLITE_STATIC);
+    if(err == SQLITE_OK)
+        get_slot(index).blob = value;
+    return err;
+}
+
+int SQLiteBindings::bind_encoded(sqlite3_stmt *stmt, int index, const Variant &value)
+{
+    int length;
+    Error err = encode_variant(value, nullptr, length);
+    if(err != OK)
+    {
+        print_error("SQLite failed to encode Variant with TYPE_* enum " + itos(value.get_type()) + ".");
+        return SQLITE_MISMATCH;
+    }
+
+    PackedByteArray blob;
+    blob.resize(sizeof(variant_tag) + length);
+    uint8_t *data = blob.ptrw();
+    memcpy(data, variant_tag, sizeof(variant_tag));
+    encode_variant(value, data + sizeof(variant_tag), length);
+    return bind_blob(stmt, index, blob);
+}
+
+bool SQLiteBindings::decode(const uint8_t *data, int size, Variant &r_value)
+{
+    int length = size - (int)sizeof(variant_tag);
+    if(length <= 0 || memcmp(data, variant_tag, sizeof(variant_tag)) != 0)
+        return false;
+
+    // The encoded Variant has to fill the rest of the blob exactly
+    int used = 0;
+    Variant value;
+    if(decode_variant(value, data + sizeof(variant_tag), length, &used) != OK || used != length)
+        return false;
+
+    r_value = value;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef GODOT_SQLITE_BINDINGS_H
+#define GODOT_SQLITE_BINDINGS_H
+
+#include "core/ustring.h"
+#include "core/variant.h"
+#include "core/vector.h"
+#include "../thirdparty/sqlite/sqlite3.h"
+
+/// Owns the text and blob buffers bound to the parameters of a statement.
+///
+/// SQLite only keeps a pointer to buffers bound with SQLITE_STATIC, so
+/// they are kept alive here until they are rebound or the statement's
+/// bindings are cleared. Text is converted to UTF-8 once, and blobs
+/// share the caller's PackedByteArray without being copied.
+class SQLiteBindings
+{
+    struct Slot
+    {
+        CharString text;
+        PackedByteArray blob;
+    };
+
+    Vector<Slot> slots; // Indexed by parameter index - 1
+
+    Slot &get_slot(int index);
+
+    public:
+    /// Binds value to the parameter at index, starting from 1
+    /// StringNames and NodePaths are bound as text, like Strings.
+    /// Types SQLite can't store natively, like vectors, transforms and colors,
+    /// are bound as blobs in the encode_variant() format, after variant_tag.
+    /// Columns declared with the VARIANT type decode them back into Variants.
+    /// Declare those columns as "VARIANT BLOB": a plain VARIANT column has
+    /// NUMERIC affinity, which stores a String like "007" as the integer 7.
+    /// Returns an SQLite result code, or SQLITE_MISMATCH after printing
+    /// an error if the Variant type can't be stored
+    int bind(sqlite3_stmt *stmt, int index, const Variant &value);
+
+    int bind_text(sqlite3_stmt *stmt, int index, const String &value);
+    int bind_blob(sqlite3_stmt *stmt, int index, const PackedByteArray &value);
+    int bind_encoded(sqlite3_stmt *stmt, int index, const Variant &value);
+
+    /// Releases every buffer. Only call this once the statement's
+    /// bindings have been cleared, or the statement was finalized.
+    void clear() {slots.clear();}
+
+    /// Prefix of the blobs written by bind_encoded(), so raw PackedByteArrays
+    /// stored in a VARIANT column aren't mistaken for encoded Variants
+    static const uint8_t variant_tag[4];
+
+    /// Decodes a blob written by bind_encoded() into r_value.
+    /// Returns false for any other blob, which should be read as bytes.
+    static bool decode(const uint8_t *data, int size, Variant &r_value);
+};
+
+#endif
@@ -0,0 +1,220 @@
+#include "sqlite_pack_vfs.h"
+#include "core/io/file_access_pack.h"
+#include "core/os/file_access.h"
+#include "../thirdparty/sqlite/sqlite3.h"
+
+struct PackFile
+{
+    sqlite3_file base; // Must be first, SQLite only knows about this part
+    FileAccess *file;
+    int64_t size;
+};
+
+static sqlite3_vfs pack_vfs;
+static sqlite3_vfs *default_vfs = nullptr;
+
+static int pack_close(sqlite3_file *sqlite_file)
+{
+    PackFile *pack_file = (PackFile *)sqlite_file;
+    memdelete(pack_file->file);
+    pack_file->file = nullptr;
+    return SQLITE_OK;
+}
+
+static int pack_read(sqlite3_file *sqlite_file, void *buffer, int amount, sqlite3_int64 offset)
+{
+    PackFile *pack_file = (PackFile *)sqlite_file;
+
+    int read = 0;
+    if(offset < pack_file->size)
+    {
+        pack_file->file->seek(offset);
+        read = pack_file->file->get_buffer((uint8_t *)buffer, amount);
+    }
+
+    if(read < amount)
+    {
+        // SQLite expects the rest of the buffer to be zeroed on a short read
+        memset((uint8_t *)buffer + read, 0, amount - read);
+        return SQLITE_IOERR_SHORT_READ;
+    }
+    return SQLITE_OK;
+}
+
+static int pack_write(sqlite3_file *sqlite_file, const void *buffer, int amount, sqlite3_int64 offset)
+{
+    return SQLITE_READONLY;
+}
+
+static int pack_truncate(sqlite3_file *sqlite_file, sqlite3_int64 size)
+{
+    return SQLITE_READONLY;
+}
+
+static int pack_sync(sqlite3_file *sqlite_file, int flags)
+{
+    return SQLITE_OK;
+}
+
+static int pack_file_size(sqlite3_file *sqlite_file, sqlite3_int64 *size)
+{
+    *size = ((PackFile *)sqlite_file)->size;
+    return SQLITE_OK;
+}
+
+// Nothing can write to a pack, so locks always succeed
+static int pack_lock(sqlite3_file *sqlite_file, int lock)
+{
+    return SQLITE_OK;
+}
+
+static int pack_check_reserved_lock(sqlite3_file *sqlite_file, int *result)
+{
+    *result = 0;
+    return SQLITE_OK;
+}
+
+static int pack_file_control(sqlite3_file *sqlite_file, int op, void *arg)
+{
+    return SQLITE_NOTFOUND;
+}
+
+static int pack_sector_size(sqlite3_file *sqlite_file)
+{
+    return 4096;
+}
+
+static int pack_device_characteristics(sqlite3_file *sqlite_file)
+{
+    return SQLITE_IOCAP_IMMUTABLE;
+}
+
+static const sqlite3_io_methods pack_io_methods = {
+    1, // iVersion
+    pack_close,
+    pack_read,
+    pack_write,
+    pack_truncate,
+    pack_sync,
+    pack_file_size,
+    pack_lock,
+    pack_lock, // xUnlock
+    pack_check_reserved_lock,
+    pack_file_control,
+    pack_sector_size,
+    pack_device_characteristics,
+};
+
+static int pack_open(sqlite3_vfs *vfs, const char *name, sqlite3_file *sqlite_file, int flags, int *out_flags)
+{
+    String path = name != nullptr ? String::utf8(name) : String();
+
+    if((flags & SQLITE_OPEN_MAIN_DB) == 0 || !path.begins_with("res://"))
+    {
+        // The file buffer is large enough for the default VFS
+        return default_vfs->xOpen(default_vfs, name, sqlite_file, flags, out_flags);
+    }
+
+    PackFile *pack_file = (PackFile *)sqlite_file;
+    pack_file->base.pMethods = nullptr; // xClose isn't called if this is null
+
+    if(flags & (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE))
+        return SQLITE_CANTOPEN;
+
+    pack_file->file = FileAccess::open(path, FileAccess::READ);
+    if(pack_file->file == nullptr)
+        return SQLITE_CANTOPEN;
+
+    pack_file->size = pack_file->file->get_len();
+    pack_file->base.pMethods = &pack_io_methods;
+
+    if(out_flags != nullptr)
+        *out_flags = SQLITE_OPEN_READONLY;
+
+    return SQLITE_OK;
+}
+
+static int pack_delete(sqlite3_vfs *vfs, const char *name, int sync_dir)
+{
+    if(String::utf8(name).begins_with("res://"))
+        return SQLITE_READONLY;
+
+    return default_vfs->xDelete(default_vfs, name, sync_dir);
+}
+
+static int pack_access(sqlite3_vfs *vfs, const char *name, int flags, int *result)
+{
+    String path = String::utf8(name);
+    if(!path.begins_with("res://"))
+        return default_vfs->xAccess(default_vfs, name, flags, result);
+
+    *result = flags != SQLITE_ACCESS_READWRITE && FileAccess::exists(path);
+    return SQLITE_OK;
+}
+
+static int pack_full_pathname(sqlite3_vfs *vfs, const char *name, int out_size, char *out)
+{
+    if(!String::utf8(name).begins_with("res://"))
+        return default_vfs->xFullPathname(default_vfs, name, out_size, out);
+
+    // res:// paths are already absolute
+    sqlite3_snprintf(out_size, out, "%s", name);
+    return SQLITE_OK;
+}
+
+static int pack_randomness(sqlite3_vfs *vfs, int size, char *out)
+{
+    return default_vfs->xRandomness(default_vfs, size, out);
+}
+
+static int pack_sleep(sqlite3_vfs *vfs, int microseconds)
+{
+    return default_vfs->xSleep(default_vfs, microseconds);
+}
+
+static int pack_current_time(sqlite3_vfs *vfs, double *out)
+{
+    return default_vfs->xCurrentTime(default_vfs, out);
+}
+
+static int pack_get_last_error(sqlite3_vfs *vfs, int size, char *out)
+{
+    return default_vfs->xGetLastError(default_vfs, size, out);
+}
+
+void sqlite_pack_vfs_register()
+{
+    default_vfs = sqlite3_vfs_find(nullptr);
+    ERR_FAIL_COND_MSG(default_vfs == nullptr, "SQLite has no default VFS to delegate to.");
+
+    memset(&pack_vfs, 0, sizeof(pack_vfs));
+    pack_vfs.iVersion = 1;
+    pack_vfs.szOsFile = MAX((int)sizeof(PackFile), default_vfs->szOsFile);
+    pack_vfs.mxPathname = default_vfs->mxPathname;
+    pack_vfs.zName = SQLITE_PACK_VFS_NAME;
+    pack_vfs.xOpen = pack_open;
+    pack_vfs.xDelete = pack_delete;
+    pack_vfs.xAccess = pack_access;
+    pack_vfs.xFullPathname = pack_full_pathname;
+    pack_vfs.xRandomness = pack_randomness;
+    pack_vfs.xSleep = pack_sleep;
+    pack_vfs.xCurrentTime = pack_current_time;
+    pack_vfs.xGetLastError = pack_get_last_error;
+
+    sqlite3_vfs_register(&pack_vfs, 0);
+}
+
+void sqlite_pack_vfs_unregister()
+{
+    if(default_vfs == nullptr)
+        return;
+
+    sqlite3_vfs_unregister(&pack_vfs);
+    default_vfs = nullptr;
+}
+
+bool sqlite_pack_vfs_is_packed(const String &path)
+{
+    PackedData *packed_data = PackedData::get_singleton();
+    return path.begins_with("res://") && packed_data != nullptr && !packed_data->is_disabled() && packed_data->has_path(path);
+}
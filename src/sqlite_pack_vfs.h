@@ -0,0 +1,20 @@
+#ifndef GODOT_SQLITE_PACK_VFS_H
+#define GODOT_SQLITE_PACK_VFS_H
+
+#include "core/ustring.h"
+
+/// Read-only SQLite VFS that reads res:// databases through FileAccess,
+/// so databases exported inside a .pck can be opened in place.
+///
+/// Database files are treated as immutable, so SQLite skips locking
+/// and never looks for a journal. Every other file, like temporary
+/// files, is handled by the default VFS.
+#define SQLITE_PACK_VFS_NAME "godot_pack"
+
+void sqlite_pack_vfs_register();
+void sqlite_pack_vfs_unregister();
+
+/// Returns true if path is a res:// file stored in a loaded pack
+bool sqlite_pack_vfs_is_packed(const String &path);
+
+#endif
@@ -0,0 +1,253 @@
+#include "sqlite_query_stats.h"
+#include "core/dictionary.h"
+#include "core/sort_array.h"
+
+static bool is_identifier_char(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' || (unsigned char)c >= 0x80;
+}
+
+String SQLiteQueryStats::normalize(const char *sql)
+{
+    Vector<char> out;
+
+    const char *c = sql;
+    bool pending_space = false;
+    while(*c)
+    {
+        if(*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r')
+        {
+            pending_space = !out.empty();
+            c++;
+            continue;
+        }
+        if(c[0] == '-' && c[1] == '-')
+        {
+            while(*c && *c != '\n')
+                c++;
+            continue;
+        }
+        if(c[0] == '/' && c[1] == '*')
+        {
+            c += 2;
+            while(*c && !(c[0] == '*' && c[1] == '/'))
+                c++;
+            if(*c)
+                c += 2;
+            pending_space = !out.empty();
+            continue;
+        }
+
+        if(pending_space)
+        {
+            out.push_back(' ');
+            pending_space = false;
+        }
+
+        if(*c == '\'' || ((*c == 'x' || *c == 'X') && c[1] == '\'' && (c == sql || !is_identifier_char(c[-1]))))
+        {
+            // String or blob literal, where '' escapes a quote
+            if(*c != '\'')
+                c++;
+            c++;
+            while(*c)
+            {
+                if(*c == '\'')
+                {
+                    if(c[1] != '\'')
+                        break;
+                    c++;
+                }
+                c++;
+            }
+            if(*c)
+                c++;
+            out.push_back('?');
+        }
+        else if(*c == '"' || *c == '`' || *c == '[')
+        {
+            // Quoted identifiers are kept as they are
+            char end = *c == '[' ? ']' : *c;
+            out.push_back(*c++);
+            while(*c && *c != end)
+                out.push_back(*c++);
+            if(*c)
+                out.push_back(*c++);
+        }
+        else if(((*c >= '0' && *c <= '9') || (*c == '.' && c[1] >= '0' && c[1] <= '9')) && (c == sql || !is_identifier_char(c[-1])))
+        {
+            // Numbers, including hexadecimal and exponents
+            while(is_identifier_char(*c) || *c == '.' || ((*c == '+' || *c == '-') && (c[-1] == 'e' || c[-1] == 'E')))
+                c++;
+            out.push_back('?');
+        }
+        else
+        {
+            out.push_back(*c++);
+        }
+    }
+
+    String normalized;
+    normalized.parse_utf8(out.ptr(), out.size());
+    return normalized;
+}
+
+int SQLiteQueryStats::trace_callback(unsigned int type, void *userdata, void *p, void *x)
+{
+    SQLiteQueryStats *stats = (SQLiteQueryStats *)userdata;
+    sqlite3_stmt *stmt = (sqlite3_stmt *)p;
+
+    // Query plans, like the ones of the slow query log, aren't part of the workload
+    if(sqlite3_stmt_isexplain(stmt))
+        return 0;
+
+    if(type == SQLITE_TRACE_ROW)
+    {
+        MutexLock lock(stats->mutex);
+        uint64_t key = (uint64_t)(uintptr_t)stmt;
+        uint64_t *rows = stats->pending_rows.getptr(key);
+        if(rows != nullptr)
+            (*rows)++;
+        else
+            stats->pending_rows.set(key, 1);
+    }
+    else if(type == SQLITE_TRACE_PROFILE)
+    {
+        stats->record(stmt, *(sqlite3_int64 *)x);
+    }
+
+    return 0;
+}
+
+String SQLiteQueryStats::get_normalized(sqlite3_stmt *stmt)
+{
+    const char *sql = sqlite3_sql(stmt);
+    if(sql == nullptr)
+        sql = "";
+    uint64_t key = (uint64_t)(uintptr_t)stmt;
+
+    {
+        MutexLock lock(mutex);
+        const Normalized *cached = normalized.getptr(key);
+        if(cached != nullptr && strcmp(cached->sql.get_data(), sql) == 0)
+            return cached->statement;
+    }
+
+    // Normalized outside of the lock, as it's the expensive part
+    Normalized entry;
+    entry.sql = CharString(sql);
+    entry.statement = normalize(sql);
+
+    MutexLock lock(mutex);
+    if(normalized.size() >= NORMALIZED_COUNT)
+        normalized.clear();
+    normalized.set(key, entry);
+    return entry.statement;
+}
+
+void SQLiteQueryStats::record(sqlite3_stmt *stmt, uint64_t ns)
+{
+    String statement = get_normalized(stmt);
+    uint64_t scanned = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+
+    MutexLock lock(mutex);
+
+    uint64_t rows = 0;
+    uint64_t key = (uint64_t)(uintptr_t)stmt;
+    uint64_t *pending = pending_rows.getptr(key);
+    if(pending != nullptr)
+    {
+        rows = *pending;
+        pending_rows.erase(key);
+    }
+
+    Entry *entry = entries.getptr(statement);
+    if(entry == nullptr)
+    {
+        entries.set(statement, Entry());
+        entry = entries.getptr(statement);
+        entry->min_ns = ns;
+    }
+
+    entry->calls++;
+    entry->total_ns += ns;
+    entry->min_ns = MIN(entry->min_ns, ns);
+    entry->max_ns = MAX(entry->max_ns, ns);
+    entry->rows_returned += rows;
+    entry->rows_scanned += scanned;
+
+    if(entry->samples.size() < SAMPLE_COUNT)
+    {
+        entry->samples.push_back(ns);
+    }
+    else
+    {
+        entry->samples.set(entry->next_sample, ns);
+        entry->next_sample = (entry->next_sample + 1) % SAMPLE_COUNT;
+    }
+}
+
+void SQLiteQueryStats::attach(sqlite3 *db)
+{
+    sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, trace_callback, this);
+}
+
+void SQLiteQueryStats::detach(sqlite3 *db)
+{
+    sqlite3_trace_v2(db, 0, nullptr, nullptr);
+}
+
+struct QueryStatsComparator
+{
+    _FORCE_INLINE_ bool operator()(const Variant &a, const Variant &b) const
+    {
+        return (double)((Dictionary)a)["total_usec"] > (double)((Dictionary)b)["total_usec"];
+    }
+};
+
+Array SQLiteQueryStats::get_stats()
+{
+    Vector<Variant> stats;
+
+    {
+        MutexLock lock(mutex);
+
+        const String *key = nullptr;
+        while((key = entries.next(key)))
+        {
+            const Entry &entry = entries[*key];
+
+            Vector<uint64_t> samples = entry.samples;
+            samples.sort();
+            int p99_index = MIN(samples.size() - 1, (samples.size() * 99) / 100);
+
+            Dictionary stat;
+            stat["statement"] = *key;
+            stat["calls"] = entry.calls;
+            stat["total_usec"] = entry.total_ns / 1000.0;
+            stat["min_usec"] = entry.min_ns / 1000.0;
+            stat["max_usec"] = entry.max_ns / 1000.0;
+            stat["p99_usec"] = samples[p99_index] / 1000.0;
+            stat["rows_returned"] = entry.rows_returned;
+            stat["rows_scanned"] = entry.rows_scanned;
+            stats.push_back(stat);
+        }
+    }
+
+    stats.sort_custom<QueryStatsComparator>();
+
+    Array result;
+    result.resize(stats.size());
+    for(int i = 0; i < stats.size(); i++)
+    {
+        result[i] = stats[i];
+    }
+    return result;
+}
+
+void SQLiteQueryStats::reset()
+{
+    MutexLock lock(mutex);
+    entries.clear();
+    pending_rows.clear();
+}
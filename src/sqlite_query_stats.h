@@ -0,0 +1,68 @@
+#ifndef GODOT_SQLITE_QUERY_STATS_H
+#define GODOT_SQLITE_QUERY_STATS_H
+
+#include "core/array.h"
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/ustring.h"
+#include "core/vector.h"
+#include "../thirdparty/sqlite/sqlite3.h"
+
+/// Execution statistics of SQLite statements, aggregated by statement text
+/// with its literals replaced by "?".
+///
+/// Filled in by SQLite's SQLITE_TRACE_PROFILE and SQLITE_TRACE_ROW events
+/// once attach() has been called on a connection. Several connections can
+/// share the same stats. EXPLAIN statements aren't recorded.
+class SQLiteQueryStats
+{
+    static const int SAMPLE_COUNT = 512; // Durations kept per statement for the percentiles
+    static const int NORMALIZED_COUNT = 1024; // Normalized statements cached before the cache is cleared
+
+    struct Entry
+    {
+        uint64_t calls = 0;
+        uint64_t total_ns = 0;
+        uint64_t min_ns = 0;
+        uint64_t max_ns = 0;
+        uint64_t rows_returned = 0;
+        uint64_t rows_scanned = 0;
+        Vector<uint64_t> samples; // Ring buffer of the last SAMPLE_COUNT durations
+        int next_sample = 0;
+    };
+
+    struct Normalized
+    {
+        CharString sql; // Text the statement was prepared from
+        String statement;
+    };
+
+    HashMap<String, Entry> entries;
+    // Statements are normalized once, the pointer can be reused by
+    // a statement with another text once the first one is finalized
+    HashMap<uint64_t, Normalized> normalized;
+    HashMap<uint64_t, uint64_t> pending_rows; // Rows returned so far by each running statement
+
+    Mutex mutex;
+
+    static int trace_callback(unsigned int type, void *userdata, void *p, void *x);
+
+    /// Returns the normalized text of stmt, normalizing it on its first run only
+    String get_normalized(sqlite3_stmt *stmt);
+    void record(sqlite3_stmt *stmt, uint64_t ns);
+
+    public:
+    /// Returns sql with its comments removed, its whitespace collapsed, and
+    /// every string, number and blob literal replaced by "?"
+    static String normalize(const char *sql);
+
+    /// Starts or stops recording the statements run on db
+    void attach(sqlite3 *db);
+    static void detach(sqlite3 *db);
+
+    /// Returns one Dictionary per statement, slowest total time first
+    Array get_stats();
+    void reset();
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "sqlite_statement_cache.h"
+
+// Returns true if sql starts with a statement that changes the schema
+static bool is_schema_statement(const String &sql)
+{
+    String stripped = sql.strip_edges();
+    int length = 0;
+    while(length < stripped.length())
+    {
+        CharType c = stripped[length];
+        if(!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')))
+            break;
+        length++;
+    }
+
+    String keyword = stripped.substr(0, length).to_upper();
+    return keyword == "CREATE" || keyword == "DROP" || keyword == "ALTER";
+}
+
+void SQLiteStatementCache::set_capacity(int value)
+{
+    ERR_FAIL_COND(value < 0);
+
+    MutexLock lock(mutex);
+    capacity = value;
+    trim();
+}
+
+void SQLiteStatementCache::trim()
+{
+    while(entries.size() > capacity)
+    {
+        List<Entry>::Element *E = entries.back();
+        sqlite3_finalize(E->get().stmt);
+        lookup.erase(E->get().sql);
+        entries.erase(E);
+        evictions++;
+    }
+}
+
+sqlite3_stmt *SQLiteStatementCache::acquire(const String &sql)
+{
+    {
+        MutexLock lock(mutex);
+
+        List<Entry>::Element **E = lookup.getptr(sql);
+        if(E != nullptr)
+        {
+            sqlite3_stmt *stmt = (*E)->get().stmt;
+            entries.erase(*E);
+            lookup.erase(sql);
+            hits++;
+            return stmt;
+        }
+
+        misses++;
+    }
+
+    // Statements that will be reused are worth a more thorough plan
+    unsigned int flags = capacity > 0 ? SQLITE_PREPARE_PERSISTENT : 0;
+
+    sqlite3_stmt *stmt;
+    int err = sqlite3_prepare_v3(connection, sql.utf8().get_data(), -1, flags, &stmt, nullptr);
+    if(err != SQLITE_OK)
+    {
+        print_error(String("SQLite error: ") + sqlite3_errmsg(connection));
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+
+    return stmt;
+}
+
+void SQLiteStatementCache::release(const String &sql, sqlite3_stmt *stmt)
+{
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    MutexLock lock(mutex);
+
+    if(is_schema_statement(sql))
+    {
+        // Cached plans may refer to tables and indexes that just changed
+        sqlite3_finalize(stmt);
+        flush();
+        return;
+    }
+
+    if(capacity == 0 || lookup.has(sql))
+    {
+        sqlite3_finalize(stmt);
+        return;
+    }
+
+    Entry entry;
+    entry.sql = sql;
+    entry.stmt = stmt;
+    lookup.set(sql, entries.push_front(entry));
+    trim();
+}
+
+void SQLiteStatementCache::flush()
+{
+    MutexLock lock(mutex);
+
+    for(List<Entry>::Element *E = entries.front(); E; E = E->next())
+    {
+        sqlite3_finalize(E->get().stmt);
+    }
+    entries.clear();
+    lookup.clear();
+}
+
+void SQLiteStatementCache::reset_counters()
+{
+    MutexLock lock(mutex);
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+}
+
+SQLiteStatementCache::~SQLiteStatementCache()
+{
+    flush();
+}
@@ -0,0 +1,67 @@
+#ifndef GODOT_SQLITE_STATEMENT_CACHE_H
+#define GODOT_SQLITE_STATEMENT_CACHE_H
+
+#include "core/hash_map.h"
+#include "core/list.h"
+#include "core/os/mutex.h"
+#include "core/ustring.h"
+#include "../thirdparty/sqlite/sqlite3.h"
+
+/// Bounded LRU cache of prepared statements for a single SQLite connection,
+/// keyed by SQL text.
+///
+/// Statements are checked out with acquire() and handed back with release(),
+/// so a statement is never used by two cursors at the same time. Only idle
+/// statements count towards the capacity.
+class SQLiteStatementCache
+{
+    struct Entry
+    {
+        String sql;
+        sqlite3_stmt *stmt = nullptr;
+    };
+
+    sqlite3 *connection = nullptr;
+    int capacity = 32;
+
+    List<Entry> entries; // Most recently used first
+    HashMap<String, List<Entry>::Element *> lookup;
+
+    Mutex mutex;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    /// Finalizes least recently used statements until the cache fits its capacity
+    void trim();
+
+    public:
+    void set_connection(sqlite3 *value) {connection = value;}
+
+    /// Maximum number of idle statements kept prepared.
+    /// 0 disables caching.
+    void set_capacity(int value);
+    int get_capacity() const {return capacity;}
+
+    /// Returns a prepared statement for sql, reusing a cached one if possible.
+    /// Returns nullptr and prints an error if the statement fails to compile.
+    sqlite3_stmt *acquire(const String &sql);
+
+    /// Resets stmt and returns it to the cache.
+    /// Statements that change the schema flush the whole cache.
+    void release(const String &sql, sqlite3_stmt *stmt);
+
+    /// Finalizes every idle statement
+    void flush();
+
+    int get_size() const {return entries.size();}
+    uint64_t get_hits() const {return hits;}
+    uint64_t get_misses() const {return misses;}
+    uint64_t get_evictions() const {return evictions;}
+    void reset_counters();
+
+    ~SQLiteStatementCache();
+};
+
+#endif